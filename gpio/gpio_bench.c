@@ -0,0 +1,274 @@
+/**
+ * gpio_bench.c - gpio_daemon 只读查询压力测试工具
+ *
+ * 两种模式：
+ * 1. 持久连接（默认）：每个线程一个 gpio_client，连接池内每个连接保持固定数量的流水线请求
+ * 2. 短连接（-n）：每个请求新建连接并使用旧协议，模拟大量监控脚本的突发查询，
+ *    统计被拒绝或重置的连接
+ *
+ * 编译：make gpio_bench
+ * 运行：./gpio_bench -T 4 -c 4 -d 8 -s 10
+ *       ./gpio_bench -n -T 32 -s 10
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/socket.h>
+
+#include "gpio_client.h"
+
+#define MAX_THREADS   256
+#define MAX_SAMPLES   (1 << 20)   // 每个线程最多保留的延迟样本数
+
+struct bench_thread;
+
+/* 一个在途请求，完成后立即用同一槽位提交下一个请求 */
+struct bench_slot {
+    struct bench_thread *t;
+    struct timespec sent;
+};
+
+struct bench_thread {
+    pthread_t thread;
+    gpio_client *client;
+    struct bench_slot *slots;
+    unsigned long ok;
+    unsigned long errors;
+    unsigned long mismatched;        // 响应与期望前缀不符
+    double *samples;                 // 延迟样本(毫秒)
+    int sample_count;
+};
+
+static const char *host = "localhost";
+static const char *port = "8888";
+static const char *command = "status";
+static const char *expect = "STATUS:";
+static int conns_per_thread = 4;
+static int depth = 8;
+static int duration_s = 10;
+static volatile int stop = 0;
+
+static double elapsed_ms(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) * 1000.0 + (b->tv_nsec - a->tv_nsec) / 1e6;
+}
+
+static void record(struct bench_thread *t, const struct timespec *sent, int ok) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (!ok) {
+        t->errors++;
+        return;
+    }
+    t->ok++;
+    if (t->sample_count < MAX_SAMPLES)
+        t->samples[t->sample_count++] = elapsed_ms(sent, &now);
+}
+
+static void on_reply(void *arg, int status, const char *response) {
+    struct bench_slot *slot = arg;
+    struct bench_thread *t = slot->t;
+
+    if (status == GPIO_CLIENT_OK && strncmp(response, expect, strlen(expect)) != 0)
+        t->mismatched++;
+    record(t, &slot->sent, status == GPIO_CLIENT_OK);
+
+    if (stop)
+        return;
+    clock_gettime(CLOCK_MONOTONIC, &slot->sent);
+    if (gpio_client_submit(t->client, command, on_reply, slot) != 0)
+        t->errors++;
+}
+
+/* 持久连接模式 */
+static void *persistent_thread(void *arg) {
+    struct bench_thread *t = arg;
+    int inflight = conns_per_thread * depth;
+
+    for (int i = 0; i < inflight; i++) {
+        t->slots[i].t = t;
+        clock_gettime(CLOCK_MONOTONIC, &t->slots[i].sent);
+        if (gpio_client_submit(t->client, command, on_reply, &t->slots[i]) != 0)
+            t->errors++;
+    }
+
+    while (gpio_client_pending(t->client) > 0) {
+        struct pollfd fds[GPIO_CLIENT_MAX_POOL];
+        int n = gpio_client_pollfds(t->client, fds, GPIO_CLIENT_MAX_POOL);
+        poll(fds, n, gpio_client_next_timeout(t->client));
+        gpio_client_process(t->client, fds, n);
+    }
+    return NULL;
+}
+
+/* 短连接模式：每个请求 连接-发送-接收-关闭 */
+static void *connect_thread(void *arg) {
+    struct bench_thread *t = arg;
+    struct addrinfo hints, *res;
+    char buf[GPIO_CLIENT_RESPONSE_SIZE];
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &res) != 0) {
+        t->errors++;
+        return NULL;
+    }
+
+    while (!stop) {
+        struct timespec sent;
+        clock_gettime(CLOCK_MONOTONIC, &sent);
+
+        int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        int ok = 0;
+        if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) == 0 &&
+            write(fd, command, strlen(command)) == (ssize_t)strlen(command)) {
+            size_t len = 0;
+            ssize_t n;
+            while (len < sizeof(buf) - 1 && (n = read(fd, buf + len, sizeof(buf) - 1 - len)) > 0)
+                len += n;
+            buf[len] = '\0';
+            ok = len > 0;
+            if (ok && strncmp(buf, expect, strlen(expect)) != 0)
+                t->mismatched++;
+        }
+        if (fd >= 0)
+            close(fd);
+        record(t, &sent, ok);
+    }
+
+    freeaddrinfo(res);
+    return NULL;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "用法: %s [-H host] [-p port] [-T threads] [-c conns] [-d depth] [-s seconds]\n"
+            "          [-C command] [-e expect] [-n]\n"
+            "  -H host     服务器地址，默认: localhost\n"
+            "  -p port     服务器端口，默认: 8888\n"
+            "  -T threads  客户端线程数，默认: 4\n"
+            "  -c conns    每个线程的连接数(持久连接模式)，默认: 4\n"
+            "  -d depth    每个连接的流水线深度(持久连接模式)，默认: 8\n"
+            "  -s seconds  测试时长，默认: 10\n"
+            "  -C command  查询命令，默认: status\n"
+            "  -e expect   期望的响应前缀，默认: STATUS:\n"
+            "  -n          短连接模式：每个请求新建连接\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    int threads = 4;
+    int connect_mode = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "H:p:T:c:d:s:C:e:nh")) != -1) {
+        switch (opt) {
+            case 'H': host = optarg; break;
+            case 'p': port = optarg; break;
+            case 'T': threads = atoi(optarg); break;
+            case 'c': conns_per_thread = atoi(optarg); break;
+            case 'd': depth = atoi(optarg); break;
+            case 's': duration_s = atoi(optarg); break;
+            case 'C': command = optarg; break;
+            case 'e': expect = optarg; break;
+            case 'n': connect_mode = 1; break;
+            case 'h': print_usage(argv[0]); return EXIT_SUCCESS;
+            default:
+                print_usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (threads < 1 || threads > MAX_THREADS ||
+        conns_per_thread < 1 || conns_per_thread > GPIO_CLIENT_MAX_POOL ||
+        depth < 1 || depth > GPIO_CLIENT_MAX_INFLIGHT || duration_s < 1) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    struct bench_thread *t = calloc(threads, sizeof(*t));
+    for (int i = 0; i < threads; i++) {
+        t[i].samples = malloc(MAX_SAMPLES * sizeof(double));
+        if (!t[i].samples) {
+            fprintf(stderr, "内存不足\n");
+            return EXIT_FAILURE;
+        }
+        if (!connect_mode) {
+            t[i].client = gpio_client_new(host, port, conns_per_thread);
+            if (!t[i].client) {
+                fprintf(stderr, "无法创建客户端 %s:%s\n", host, port);
+                return EXIT_FAILURE;
+            }
+            t[i].slots = calloc(conns_per_thread * depth, sizeof(struct bench_slot));
+        }
+    }
+
+    printf("%s模式: %s:%s 命令=%s 线程=%d", connect_mode ? "短连接" : "持久连接",
+           host, port, command, threads);
+    if (!connect_mode)
+        printf(" 连接=%d 深度=%d", threads * conns_per_thread, depth);
+    printf(" 时长=%ds\n", duration_s);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&t[i].thread, NULL, connect_mode ? connect_thread : persistent_thread, &t[i]);
+    }
+    sleep(duration_s);
+    stop = 1;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(t[i].thread, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    /* 汇总 */
+    unsigned long ok = 0, errors = 0, mismatched = 0;
+    int sample_total = 0;
+    for (int i = 0; i < threads; i++) {
+        ok += t[i].ok;
+        errors += t[i].errors;
+        mismatched += t[i].mismatched;
+        sample_total += t[i].sample_count;
+    }
+    double *all = malloc((sample_total ? sample_total : 1) * sizeof(double));
+    int pos = 0;
+    for (int i = 0; i < threads; i++) {
+        memcpy(all + pos, t[i].samples, t[i].sample_count * sizeof(double));
+        pos += t[i].sample_count;
+    }
+    qsort(all, sample_total, sizeof(double), compare_double);
+
+    double secs = elapsed_ms(&start, &end) / 1000.0;
+    printf("成功: %lu  失败: %lu  响应不符: %lu\n", ok, errors, mismatched);
+    printf("吞吐: %.0f 请求/秒\n", ok / secs);
+    if (sample_total > 0) {
+        /* 最近秩法取百分位 */
+        printf("延迟(ms): p50=%.3f p90=%.3f p99=%.3f max=%.3f\n",
+               all[(sample_total * 50 + 99) / 100 - 1],
+               all[(sample_total * 90 + 99) / 100 - 1],
+               all[(sample_total * 99 + 99) / 100 - 1],
+               all[sample_total - 1]);
+    }
+
+    free(all);
+    for (int i = 0; i < threads; i++) {
+        if (t[i].client)
+            gpio_client_free(t[i].client);
+        free(t[i].slots);
+        free(t[i].samples);
+    }
+    free(t);
+    return errors > 0 || mismatched > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,464 @@
+/**
+ * gpio_client.c - gpio_daemon RPC 客户端库实现
+ *
+ * 使用守护进程的行模式：每条命令以换行结尾，响应同样以换行结尾并按顺序返回，
+ * 因此同一连接上可以连续发送多条命令，每个连接维护一个先进先出的请求队列。
+ */
+
+#include "gpio_client.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+
+#define MAX_ADDRS     4      // 最多保留的解析结果
+#define OUT_BUF_SIZE  4096   // 每个连接的发送缓冲区
+#define HOST_MAX_LEN  256
+#define PORT_MAX_LEN  32
+
+#define CONN_IDLE       0
+#define CONN_CONNECTING 1
+#define CONN_CONNECTED  2
+
+struct request {
+    gpio_client_cb cb;
+    void *arg;
+    struct timespec deadline;
+};
+
+struct conn {
+    int fd;
+    int state;
+    unsigned int gen;                        // 每次连接被重置时递增，用于发现回调中发生的重置
+    char out[OUT_BUF_SIZE];                  // 尚未发出的命令
+    size_t out_len;
+    char in[GPIO_CLIENT_RESPONSE_SIZE];      // 尚未遇到换行的响应
+    size_t in_len;
+    struct request queue[GPIO_CLIENT_MAX_INFLIGHT];
+    int head;
+    int count;
+};
+
+struct gpio_client {
+    char host[HOST_MAX_LEN];
+    char port[PORT_MAX_LEN];
+    struct sockaddr_storage addrs[MAX_ADDRS];
+    socklen_t addr_lens[MAX_ADDRS];
+    int addr_count;
+    int addr_index;                          // 当前使用的地址，连接失败时切换到下一个
+    int pool_size;
+    int timeout_ms;
+    struct conn conns[GPIO_CLIENT_MAX_POOL];
+};
+
+static void now_plus(struct timespec *ts, int ms) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+static long ms_until(const struct timespec *ts) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (ts->tv_sec - now.tv_sec) * 1000L + (ts->tv_nsec - now.tv_nsec) / 1000000L;
+}
+
+/**
+ * 解析地址（阻塞），失败时保留原有地址
+ */
+int gpio_client_resolve(gpio_client *client) {
+    struct addrinfo hints;
+    struct addrinfo *result = NULL, *rp;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;      // 支持IPv4/IPv6
+    hints.ai_socktype = SOCK_STREAM;  // TCP
+
+    if (getaddrinfo(client->host, client->port, &hints, &result) != 0 || !result)
+        return GPIO_CLIENT_ERR_RESOLVE;
+
+    client->addr_count = 0;
+    client->addr_index = 0;
+    for (rp = result; rp != NULL && client->addr_count < MAX_ADDRS; rp = rp->ai_next) {
+        memcpy(&client->addrs[client->addr_count], rp->ai_addr, rp->ai_addrlen);
+        client->addr_lens[client->addr_count] = rp->ai_addrlen;
+        client->addr_count++;
+    }
+    freeaddrinfo(result);
+    return 0;
+}
+
+int gpio_client_resolved(const gpio_client *client) {
+    return client->addr_count > 0;
+}
+
+gpio_client *gpio_client_new(const char *host, const char *port, int pool_size) {
+    if (pool_size < 1 || pool_size > GPIO_CLIENT_MAX_POOL ||
+        strlen(host) >= HOST_MAX_LEN || strlen(port) >= PORT_MAX_LEN)
+        return NULL;
+
+    gpio_client *client = calloc(1, sizeof(*client));
+    if (!client)
+        return NULL;
+
+    strcpy(client->host, host);
+    strcpy(client->port, port);
+    gpio_client_resolve(client);
+
+    client->pool_size = pool_size;
+    client->timeout_ms = GPIO_CLIENT_DEFAULT_TIMEOUT_MS;
+    for (int i = 0; i < GPIO_CLIENT_MAX_POOL; i++)
+        client->conns[i].fd = -1;
+    return client;
+}
+
+/**
+ * 关闭连接，并以status回调其上所有未完成的请求
+ * 先复位连接状态再回调，回调中可以安全地再次提交请求
+ */
+static int conn_fail(struct conn *c, int status) {
+    struct request pending[GPIO_CLIENT_MAX_INFLIGHT];
+    int n = c->count;
+
+    for (int i = 0; i < n; i++)
+        pending[i] = c->queue[(c->head + i) % GPIO_CLIENT_MAX_INFLIGHT];
+
+    if (c->fd >= 0)
+        close(c->fd);
+    c->fd = -1;
+    c->state = CONN_IDLE;
+    c->gen++;
+    c->out_len = 0;
+    c->in_len = 0;
+    c->head = 0;
+    c->count = 0;
+
+    for (int i = 0; i < n; i++)
+        pending[i].cb(pending[i].arg, status, NULL);
+    return n;
+}
+
+void gpio_client_free(gpio_client *client) {
+    if (!client)
+        return;
+    for (int i = 0; i < GPIO_CLIENT_MAX_POOL; i++)
+        conn_fail(&client->conns[i], GPIO_CLIENT_ERR_CLOSED);
+    free(client);
+}
+
+void gpio_client_set_timeout(gpio_client *client, int timeout_ms) {
+    if (timeout_ms > 0)
+        client->timeout_ms = timeout_ms;
+}
+
+/**
+ * 发起非阻塞连接，立即失败时依次尝试其余地址
+ */
+static int conn_open(gpio_client *client, struct conn *c) {
+    for (int tries = 0; tries < client->addr_count; tries++) {
+        int idx = client->addr_index;
+        int fd = socket(client->addrs[idx].ss_family, SOCK_STREAM, 0);
+        if (fd >= 0) {
+            int opt = 1;
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+            if (connect(fd, (struct sockaddr *)&client->addrs[idx], client->addr_lens[idx]) == 0) {
+                c->fd = fd;
+                c->state = CONN_CONNECTED;
+                return 0;
+            }
+            if (errno == EINPROGRESS) {
+                c->fd = fd;
+                c->state = CONN_CONNECTING;
+                return 0;
+            }
+            close(fd);
+        }
+        client->addr_index = (client->addr_index + 1) % client->addr_count;
+    }
+    return GPIO_CLIENT_ERR_CONNECT;
+}
+
+/**
+ * 尽可能发出发送缓冲区中的数据
+ */
+static int conn_flush(struct conn *c) {
+    while (c->out_len > 0) {
+        ssize_t n = send(c->fd, c->out, c->out_len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 0;
+            return GPIO_CLIENT_ERR_IO;
+        }
+        memmove(c->out, c->out + n, c->out_len - n);
+        c->out_len -= n;
+    }
+    return 0;
+}
+
+/**
+ * 选择连接：优先使用排队最少的已有连接，已有连接都在忙且连接池未满时新建连接
+ */
+static struct conn *pick_conn(gpio_client *client) {
+    struct conn *best = NULL, *free_slot = NULL;
+
+    for (int i = 0; i < client->pool_size; i++) {
+        struct conn *c = &client->conns[i];
+        if (c->fd < 0) {
+            if (!free_slot)
+                free_slot = c;
+            continue;
+        }
+        if (!best || c->count < best->count)
+            best = c;
+    }
+
+    if (free_slot && (!best || best->count > 0))
+        return free_slot;
+    return best;
+}
+
+int gpio_client_submit(gpio_client *client, const char *cmd, gpio_client_cb cb, void *arg) {
+    /* 解析会阻塞，不在提交路径上重试，由调用者在空闲时调用gpio_client_resolve */
+    if (client->addr_count == 0)
+        return GPIO_CLIENT_ERR_RESOLVE;
+
+    struct conn *c = pick_conn(client);
+    size_t cmd_len = strlen(cmd);
+
+    if (c->fd < 0) {
+        int ret = conn_open(client, c);
+        if (ret < 0)
+            return ret;
+    }
+    if (c->count >= GPIO_CLIENT_MAX_INFLIGHT || c->out_len + cmd_len + 1 > OUT_BUF_SIZE)
+        return GPIO_CLIENT_ERR_FULL;
+
+    memcpy(c->out + c->out_len, cmd, cmd_len);
+    c->out[c->out_len + cmd_len] = '\n';
+    c->out_len += cmd_len + 1;
+
+    struct request *req = &c->queue[(c->head + c->count) % GPIO_CLIENT_MAX_INFLIGHT];
+    req->cb = cb;
+    req->arg = arg;
+    now_plus(&req->deadline, client->timeout_ms);
+    c->count++;
+
+    if (c->state == CONN_CONNECTED && conn_flush(c) < 0)
+        conn_fail(c, GPIO_CLIENT_ERR_IO);
+    return 0;
+}
+
+int gpio_client_pending(const gpio_client *client) {
+    int n = 0;
+    for (int i = 0; i < client->pool_size; i++)
+        n += client->conns[i].count;
+    return n;
+}
+
+int gpio_client_pollfds(const gpio_client *client, struct pollfd *fds, int max) {
+    int n = 0;
+    for (int i = 0; i < client->pool_size && n < max; i++) {
+        const struct conn *c = &client->conns[i];
+        if (c->fd < 0)
+            continue;
+        fds[n].fd = c->fd;
+        fds[n].events = POLLIN;
+        if (c->state == CONN_CONNECTING || c->out_len > 0)
+            fds[n].events |= POLLOUT;
+        fds[n].revents = 0;
+        n++;
+    }
+    return n;
+}
+
+int gpio_client_next_timeout(const gpio_client *client) {
+    long wait = -1;
+    for (int i = 0; i < client->pool_size; i++) {
+        const struct conn *c = &client->conns[i];
+        if (c->count == 0)
+            continue;
+        /* 同一连接上的请求按提交顺序排队，队首的截止时间最早 */
+        long left = ms_until(&c->queue[c->head].deadline);
+        if (left < 0)
+            left = 0;
+        if (wait < 0 || left < wait)
+            wait = left;
+    }
+    return (int)wait;
+}
+
+/**
+ * 读取响应，按行拆分并依次完成队首请求
+ * 先把完整的响应及对应请求从连接上摘下，再依次回调：回调中可能提交新请求、
+ * 使连接失败甚至在同一槽位重新连接，已收到的响应不受影响
+ */
+static int conn_read(struct conn *c) {
+    int completed = 0;
+
+    while (c->fd >= 0) {
+        ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - 1 - c->in_len, 0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return completed + conn_fail(c, GPIO_CLIENT_ERR_IO);
+        }
+        if (n == 0) {
+            /* 守护进程关闭了连接，空闲连接直接丢弃，下次提交时重连 */
+            return completed + conn_fail(c, GPIO_CLIENT_ERR_IO);
+        }
+        c->in_len += n;
+
+        char lines[GPIO_CLIENT_RESPONSE_SIZE];
+        struct request done[GPIO_CLIENT_MAX_INFLIGHT];
+        const char *text[GPIO_CLIENT_MAX_INFLIGHT];
+        int ndone = 0;
+        size_t used = 0;
+        char *nl;
+        while ((nl = memchr(c->in + used, '\n', c->in_len - used)) != NULL) {
+            size_t len = nl - (c->in + used);
+            char *line = lines + used;
+            memcpy(line, c->in + used, len);
+            line[len] = '\0';
+            if (len > 0 && line[len - 1] == '\r')
+                line[len - 1] = '\0';
+            used += len + 1;
+
+            if (c->count > 0) {
+                done[ndone] = c->queue[c->head];
+                text[ndone++] = line;
+                c->head = (c->head + 1) % GPIO_CLIENT_MAX_INFLIGHT;
+                c->count--;
+            }
+        }
+        c->in_len -= used;
+        memmove(c->in, c->in + used, c->in_len);
+        int too_long = c->in_len >= sizeof(c->in) - 1;
+
+        unsigned int gen = c->gen;
+        for (int i = 0; i < ndone; i++) {
+            done[i].cb(done[i].arg, GPIO_CLIENT_OK, text[i]);
+            completed++;
+        }
+        /* 连接在回调中被重置，剩余数据已不属于当前连接 */
+        if (c->gen != gen)
+            return completed;
+        if (too_long)
+            return completed + conn_fail(c, GPIO_CLIENT_ERR_IO);
+    }
+    return completed;
+}
+
+int gpio_client_process(gpio_client *client, const struct pollfd *fds, int nfds) {
+    int completed = 0;
+    short revents[GPIO_CLIENT_MAX_POOL];
+    unsigned int gen[GPIO_CLIENT_MAX_POOL];
+
+    /* 先记下每个连接的事件和代数，回调中被重置或重连的连接不再使用旧事件 */
+    for (int i = 0; i < client->pool_size; i++) {
+        struct conn *c = &client->conns[i];
+        revents[i] = 0;
+        gen[i] = c->gen;
+        for (int k = 0; k < nfds && c->fd >= 0; k++) {
+            if (fds[k].fd == c->fd) {
+                revents[i] = fds[k].revents;
+                break;
+            }
+        }
+    }
+
+    for (int i = 0; i < client->pool_size; i++) {
+        struct conn *c = &client->conns[i];
+        if (!revents[i] || c->gen != gen[i])
+            continue;
+
+        if (c->state == CONN_CONNECTING) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0) {
+                client->addr_index = (client->addr_index + 1) % client->addr_count;
+                completed += conn_fail(c, GPIO_CLIENT_ERR_CONNECT);
+                continue;
+            }
+            c->state = CONN_CONNECTED;
+        }
+        if (c->out_len > 0 && conn_flush(c) < 0) {
+            completed += conn_fail(c, GPIO_CLIENT_ERR_IO);
+            continue;
+        }
+        if (revents[i] & (POLLIN | POLLHUP | POLLERR))
+            completed += conn_read(c);
+    }
+
+    /* 超时：后续响应的对应关系已无法保证，整条连接作废 */
+    for (int i = 0; i < client->pool_size; i++) {
+        struct conn *c = &client->conns[i];
+        if (c->count > 0 && ms_until(&c->queue[c->head].deadline) <= 0)
+            completed += conn_fail(c, GPIO_CLIENT_ERR_TIMEOUT);
+    }
+    return completed;
+}
+
+struct call_result {
+    int done;
+    int status;
+    char *response;
+    size_t response_len;
+};
+
+static void call_cb(void *arg, int status, const char *response) {
+    struct call_result *r = arg;
+    r->done = 1;
+    r->status = status;
+    if (status == GPIO_CLIENT_OK && r->response && r->response_len > 0)
+        snprintf(r->response, r->response_len, "%s", response);
+}
+
+int gpio_client_call(gpio_client *client, const char *cmd, char *response, size_t response_len) {
+    struct call_result r = { 0, 0, response, response_len };
+    struct pollfd fds[GPIO_CLIENT_MAX_POOL];
+
+    int ret = gpio_client_submit(client, cmd, call_cb, &r);
+    if (ret < 0)
+        return ret;
+
+    while (!r.done) {
+        int n = gpio_client_pollfds(client, fds, GPIO_CLIENT_MAX_POOL);
+        if (poll(fds, n, gpio_client_next_timeout(client)) < 0 && errno != EINTR)
+            return GPIO_CLIENT_ERR_IO;
+        gpio_client_process(client, fds, n);
+    }
+    return r.status;
+}
+
+const char *gpio_client_strerror(int status) {
+    switch (status) {
+        case GPIO_CLIENT_OK:          return "成功";
+        case GPIO_CLIENT_ERR_CONNECT: return "连接失败";
+        case GPIO_CLIENT_ERR_IO:      return "读写失败或连接已关闭";
+        case GPIO_CLIENT_ERR_TIMEOUT: return "请求超时";
+        case GPIO_CLIENT_ERR_CLOSED:  return "客户端已释放";
+        case GPIO_CLIENT_ERR_FULL:    return "请求队列已满";
+        case GPIO_CLIENT_ERR_RESOLVE: return "地址解析失败";
+        default:                      return "未知错误";
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * gpio_client.h - gpio_daemon RPC 客户端库
+ *
+ * 特点：
+ * 1. 地址只解析一次，连接池内的连接长期复用（守护进程行模式）
+ * 2. 非阻塞接口，可接入外部事件循环（poll/epoll/select）
+ * 3. 同一连接上支持流水线请求，响应按顺序回调
+ * 4. 按行拼接响应，正确处理分段到达的数据
+ *
+ * 外部事件循环用法：
+ *   gpio_client *c = gpio_client_new("localhost", "8888", 2);
+ *   gpio_client_submit(c, "status", on_reply, arg);
+ *   while (gpio_client_pending(c) > 0) {
+ *       struct pollfd fds[GPIO_CLIENT_MAX_POOL];
+ *       int n = gpio_client_pollfds(c, fds, GPIO_CLIENT_MAX_POOL);
+ *       poll(fds, n, gpio_client_next_timeout(c));
+ *       gpio_client_process(c, fds, n);
+ *   }
+ *   gpio_client_free(c);
+ *
+ * 编译：make libgpio_client.a libgpio_client.so
+ */
+
+#ifndef GPIO_CLIENT_H
+#define GPIO_CLIENT_H
+
+#include <stddef.h>
+#include <poll.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPIO_CLIENT_MAX_POOL       16    // 连接池最大连接数
+#define GPIO_CLIENT_MAX_INFLIGHT   64    // 每个连接上未完成请求的上限
+#define GPIO_CLIENT_RESPONSE_SIZE  1024  // 单条响应最大长度
+#define GPIO_CLIENT_DEFAULT_TIMEOUT_MS 5000  // test_exit 需等待测试线程退出，最长约3秒
+
+/* 回调状态 */
+#define GPIO_CLIENT_OK            0
+#define GPIO_CLIENT_ERR_CONNECT  -1      // 连接失败
+#define GPIO_CLIENT_ERR_IO       -2      // 读写失败或连接被对端关闭
+#define GPIO_CLIENT_ERR_TIMEOUT  -3      // 请求超时
+#define GPIO_CLIENT_ERR_CLOSED   -4      // 客户端被释放，请求被取消
+#define GPIO_CLIENT_ERR_FULL     -5      // 请求队列已满
+#define GPIO_CLIENT_ERR_RESOLVE  -6      // 地址解析失败
+
+typedef struct gpio_client gpio_client;
+
+/**
+ * 请求完成回调，status为GPIO_CLIENT_OK时response为守护进程的响应（不含换行），否则为NULL
+ * 回调中可以再次提交请求；不能在回调中释放客户端
+ */
+typedef void (*gpio_client_cb)(void *arg, int status, const char *response);
+
+/* 创建客户端并解析地址，pool_size为连接池大小(1..GPIO_CLIENT_MAX_POOL)
+ * 会阻塞：内部调用getaddrinfo，DNS无响应时可能等待数秒
+ * 参数无效或内存不足时返回NULL；地址解析失败时仍返回客户端，
+ * 此时提交请求立即返回GPIO_CLIENT_ERR_RESOLVE，需调用gpio_client_resolve重新解析 */
+gpio_client *gpio_client_new(const char *host, const char *port, int pool_size);
+
+/* 重新解析地址，成功返回0，失败返回GPIO_CLIENT_ERR_RESOLVE并保留原有地址
+ * 会阻塞，应在事件循环空闲时按一定间隔调用，不要在每次提交前调用 */
+int gpio_client_resolve(gpio_client *client);
+
+/* 地址是否已解析 */
+int gpio_client_resolved(const gpio_client *client);
+
+/* 释放客户端，未完成的请求以GPIO_CLIENT_ERR_CLOSED回调 */
+void gpio_client_free(gpio_client *client);
+
+/* 设置单个请求的超时时间（毫秒） */
+void gpio_client_set_timeout(gpio_client *client, int timeout_ms);
+
+/* 提交请求（不阻塞），成功返回0，失败返回GPIO_CLIENT_ERR_*且不会回调
+ * 地址尚未解析时立即返回GPIO_CLIENT_ERR_RESOLVE，不会重试解析 */
+int gpio_client_submit(gpio_client *client, const char *cmd, gpio_client_cb cb, void *arg);
+
+/* 未完成的请求数 */
+int gpio_client_pending(const gpio_client *client);
+
+/* 填充需要等待的文件描述符，返回数量 */
+int gpio_client_pollfds(const gpio_client *client, struct pollfd *fds, int max);
+
+/* 距离最近一个请求超时的毫秒数，没有未完成请求时返回-1 */
+int gpio_client_next_timeout(const gpio_client *client);
+
+/* 处理poll结果（fds为gpio_client_pollfds填充的数组），同时检查超时，返回完成的请求数 */
+int gpio_client_process(gpio_client *client, const struct pollfd *fds, int nfds);
+
+/* 同步便捷接口：发送一条命令并等待响应，成功返回0 */
+int gpio_client_call(gpio_client *client, const char *cmd, char *response, size_t response_len);
+
+/* 错误码说明 */
+const char *gpio_client_strerror(int status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GPIO_CLIENT_H */
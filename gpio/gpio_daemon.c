@@ -7,9 +7,16 @@
  *    - 进入DFU模式
  *    - 复位单片机
  *    - 正常运行状态
+ * 3. 可选：采集各单片机串口输出到带时间戳的环形缓冲区，
+ *    统计复位到出现"就绪"标志(banner)的启动耗时
+ * 4. 多个接收线程通过SO_REUSEPORT共同监听RPC端口，只读查询(status/metrics)
+ *    由接收线程直接应答；其余命令交给主线程(GPIO执行器)逐条串行执行
  * 
  * 编译：gcc -Wall -o gpio_daemon gpio_daemon.c -lgpiod
  * 运行：sudo ./gpio_daemon
+ *       sudo ./gpio_daemon -s wheel:/dev/robotWheel:115200:READY
+ *       ./gpio_daemon -f -m -p 9001   (无硬件测试: 模拟GPIO, 指定端口)
+ *       sudo ./gpio_daemon -a 4       (4个接收线程，默认与CPU核数相同)
  */
 
 #include <stdio.h>
@@ -25,6 +32,10 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/inotify.h>
+#include <time.h>
 #include <gpiod.h>
 #include <pthread.h> // 添加pthread头文件
 
@@ -45,29 +56,159 @@
 /* RPC相关定义 */
 #define RPC_PORT 8888
 #define BUFFER_SIZE 1024
+#define MAX_RPC_CLIENTS 256  // 每个接收线程同时保持的客户端连接数上限
+#define MAX_ACCEPTORS 16     // 接收线程数上限
+#define RPC_BACKLOG 4096     // 监听队列长度，实际值受 net.core.somaxconn 限制
 
 /* GPIO相关定义 */
 #define CONSUMER "gpio_daemon"  // 使用者标识
 #define GPIOCHIP "gpiochip0"    // GPIO芯片名称
 
+/* 串口采集相关定义 */
+#define MAX_SERIAL_CHANNELS       8     // 最多采集的串口数量
+#define SERIAL_NAME_MAX           32
+#define SERIAL_PATH_MAX           128
+#define SERIAL_BANNER_MAX         64
+#define SERIAL_LINE_MAX           256   // 单行最大长度，超出部分截断为新行
+#define SERIAL_RING_LINES         256   // 每个通道保留的最近行数
+#define SERIAL_LATENCY_SAMPLES    128   // 每个通道保留的启动耗时样本数
+#define SERIAL_REOPEN_INTERVAL_MS 500   // 串口断开后重新打开的间隔
+#define SERIAL_FAST_REOPEN_MS     5     // 复位后等待设备重新枚举期间的重试间隔
+#define SERIAL_FAST_REOPEN_WINDOW_MS 3000  // 复位后快速重试的时长，之后按普通间隔重试
+#define POLL_TIMEOUT_MS           100   // 事件循环poll超时
+
+/* 串口一行数据及其到达时间 */
+struct serial_line {
+    struct timespec ts;                 // 行首字节到达时间(CLOCK_MONOTONIC)
+    char text[SERIAL_LINE_MAX];
+};
+
+/* 串口采集通道 */
+struct serial_channel {
+    char name[SERIAL_NAME_MAX];         // 通道名称，如 wheel
+    char path[SERIAL_PATH_MAX];         // 设备路径，如 /dev/robotWheel
+    char banner[SERIAL_BANNER_MAX];     // 单片机就绪标志字符串
+    size_t banner_len;
+    int banner_fail[SERIAL_BANNER_MAX]; // KMP失配表，逐字节增量匹配就绪标志
+    speed_t baud;
+    int fd;
+    struct timespec last_open_try;
+
+    /* 行环形缓冲区 */
+    struct serial_line lines[SERIAL_RING_LINES];
+    int line_head;                      // 下一次写入位置
+    int line_count;
+    char partial[SERIAL_LINE_MAX];      // 尚未遇到换行的当前行
+    size_t partial_len;
+    struct timespec partial_ts;
+
+    /* 复位到就绪的耗时统计 */
+    int reset_pending;                  // 已复位，尚未看到banner
+    size_t banner_match;                // 复位后当前行已匹配的就绪标志字节数
+    struct timespec reset_ts;
+    int reopened_since_reset;           // 复位后串口是否重新打开过(USB重新枚举)
+    double reopen_ms;                   // 最近一次复位到串口重新出现的耗时，-1表示未断开
+    double latency_ms[SERIAL_LATENCY_SAMPLES];
+    int latency_head;
+    int latency_count;
+    unsigned long ready_total;          // 成功检测到banner的次数
+    unsigned long missed_total;         // 再次复位前仍未看到banner的次数
+};
+
+/* RPC客户端连接
+ * 首次收到的数据含换行时进入行模式：按行处理命令、每个响应以换行结尾、连接保持，
+ * 可连续(流水线)发送多条命令；否则按旧协议处理单条命令后关闭连接，兼容 echo -n | nc
+ *
+ * 客户端归属于接收它的接收线程。需要执行器处理的命令放入cmd后挂到执行器队列，
+ * 在执行器写回response之前该连接暂停读取，保证流水线命令按顺序应答
+ */
+struct rpc_acceptor;
+
+struct rpc_client {
+    int fd;
+    int line_mode;
+    int busy;                           // 命令在执行器中排队或执行
+    int close_after;                    // 旧协议：应答后关闭连接
+    struct rpc_acceptor *owner;
+    struct rpc_client *next;            // 执行器队列/完成队列链表
+    size_t len;
+    char buf[BUFFER_SIZE];
+    char cmd[BUFFER_SIZE];
+    char response[BUFFER_SIZE + 1];
+};
+
+/* 接收线程：独立的监听套接字(SO_REUSEPORT)、客户端表和完成队列
+ * 计数器只由本线程递增，metrics查询时由其他线程读取
+ */
+struct rpc_acceptor {
+    int id;
+    int listen_fd;
+    int wake_pipe[2];                   // 执行器完成命令后唤醒本线程
+    pthread_t thread;
+    pthread_mutex_t done_lock;
+    struct rpc_client *done_head;
+    struct rpc_client *done_tail;
+    struct rpc_client *clients;         // MAX_RPC_CLIENTS个
+    int client_count;
+    unsigned long connections;          // 接受的连接数
+    unsigned long rejected;             // 因连接数上限拒绝的连接数
+    unsigned long queries;              // 本线程直接应答的只读查询数
+    unsigned long commands;             // 转交执行器的命令数
+};
+
 /* 全局变量 */
 static volatile int running = 1;
-static int current_state = STATE_NORMAL;
+static int rpc_port = RPC_PORT;
+static int mock_gpio = 0;   // 模拟GPIO，不访问硬件，用于无硬件测试
+static int acceptor_count = 0;     // 接收线程数，0表示与CPU核数相同
+static volatile int current_state = STATE_NORMAL;  // 由执行器修改，接收线程读取
 static struct gpiod_chip *chip = NULL;
 static struct gpiod_line *reset_line = NULL;
 static struct gpiod_line *boot_line = NULL;
+static struct serial_channel serial_channels[MAX_SERIAL_CHANNELS];
+static int serial_channel_count = 0;
+static int serial_inotify_fd = -1;     // 监视设备目录，串口重新出现时立即打开
+static struct rpc_acceptor acceptors[MAX_ACCEPTORS];
+
+/* GPIO执行器队列：所有改变引脚状态或读取串口数据的命令在主线程中逐条执行 */
+static pthread_mutex_t exec_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct rpc_client *exec_head = NULL;
+static struct rpc_client *exec_tail = NULL;
+static int exec_queue_len = 0;
+static int exec_pipe[2] = {-1, -1};
+static unsigned long exec_total = 0;
+static struct timespec start_time;
 
 /* 函数前向声明 */
 void signal_handler(int signo);
 void daemonize();
 int init_gpio();
+void gpio_set_value(struct gpiod_line *line, int value);
 void set_normal_state();
 void reset_mcu();
 void enter_dfu_mode();
 void enter_test_mode();
 void exit_test_mode();
 void *test_mode_thread(void *arg);
+int add_serial_channel(const char *spec);
+void serial_watch_devices();
+void serial_open_channels(int force);
+int serial_fast_reopen(const struct serial_channel *ch, const struct timespec *now);
+int serial_poll_timeout();
+void serial_read_channel(struct serial_channel *ch);
+void serial_mark_reset();
+void serial_format_stats(char *response, size_t len);
+void serial_format_log(const char *name, char *response, size_t len);
+void serial_close_channels();
+void format_status(char *response);
+void format_metrics(char *response, size_t len);
 void handle_command(char *cmd, char *response);
+int handle_query(const char *cmd, char *response);
+void executor_submit(struct rpc_client *client);
+void executor_run_queue();
+int rpc_client_process(struct rpc_client *client);
+int rpc_client_read(struct rpc_client *client);
+void *acceptor_thread(void *arg);
 int start_rpc_server();
 
 /**
@@ -144,6 +285,13 @@ void daemonize() {
  * 初始化GPIO
  */
 int init_gpio() {
+    /* 模拟模式下不打开GPIO芯片 */
+    if (mock_gpio) {
+        syslog(LOG_NOTICE, "使用模拟GPIO，不操作硬件引脚");
+        set_normal_state();
+        return 0;
+    }
+    
     /* 打开GPIO芯片 */
     chip = gpiod_chip_open_by_name(GPIOCHIP);
     if (!chip) {
@@ -187,13 +335,22 @@ int init_gpio() {
     return 0;
 }
 
+/**
+ * 设置引脚电平，模拟模式下忽略
+ */
+void gpio_set_value(struct gpiod_line *line, int value) {
+    if (mock_gpio)
+        return;
+    gpiod_line_set_value(line, value);
+}
+
 /**
  * 设置为正常运行状态
  * BOOT引脚输出高电平，RST引脚输出低电平
  */
 void set_normal_state() {
-    gpiod_line_set_value(boot_line, !DFU_MODE_TRIGGER_STATE);  // BOOT引脚高电平
-    gpiod_line_set_value(reset_line, !RESET_PIN_TRIGGER_STATE); // RST引脚低电平
+    gpio_set_value(boot_line, !DFU_MODE_TRIGGER_STATE);  // BOOT引脚高电平
+    gpio_set_value(reset_line, !RESET_PIN_TRIGGER_STATE); // RST引脚低电平
     current_state = STATE_NORMAL;
     syslog(LOG_INFO, "设置为正常运行状态");
 }
@@ -209,7 +366,7 @@ void reset_mcu() {
     int old_state = current_state;
     
     /* 设置RESET_PIN为触发状态 */
-    gpiod_line_set_value(reset_line, RESET_PIN_TRIGGER_STATE);
+    gpio_set_value(reset_line, RESET_PIN_TRIGGER_STATE);
     current_state = STATE_RESET;
     
     /* 延时300ms */
@@ -218,6 +375,7 @@ void reset_mcu() {
     /* 恢复到之前的状态 */
     if (old_state == STATE_NORMAL) {
         set_normal_state();
+        serial_mark_reset();
     } else {
         /* 如果之前是DFU模式，则恢复到DFU模式 */
         enter_dfu_mode();
@@ -233,22 +391,22 @@ void enter_dfu_mode() {
     syslog(LOG_INFO, "执行进入DFU模式...");
     
     /* 设置BOOT_PIN为DFU模式触发状态 */
-    gpiod_line_set_value(boot_line, DFU_MODE_TRIGGER_STATE);
+    gpio_set_value(boot_line, DFU_MODE_TRIGGER_STATE);
     
     /* 设置RESET_PIN为触发状态 */
-    gpiod_line_set_value(reset_line, RESET_PIN_TRIGGER_STATE);
+    gpio_set_value(reset_line, RESET_PIN_TRIGGER_STATE);
     
     /* 延时100ms */
     usleep(100000);
     
     /* 将RESET_PIN设置为非触发状态 */
-    gpiod_line_set_value(reset_line, !RESET_PIN_TRIGGER_STATE);
+    gpio_set_value(reset_line, !RESET_PIN_TRIGGER_STATE);
     
     /* 延时100ms */
     usleep(100000);
     
     /* 保持BOOT_PIN为DFU模式触发状态 */
-    gpiod_line_set_value(boot_line, DFU_MODE_TRIGGER_STATE);
+    gpio_set_value(boot_line, DFU_MODE_TRIGGER_STATE);
     
     current_state = STATE_DFU;
     syslog(LOG_INFO, "DFU模式设置完成");
@@ -266,8 +424,8 @@ void *test_mode_thread(void *arg) {
     
     while (test_running) {
         /* 设置BOOT_PIN和RESET_PIN为高电平 */
-        gpiod_line_set_value(boot_line, 1);
-        gpiod_line_set_value(reset_line, 1);
+        gpio_set_value(boot_line, 1);
+        gpio_set_value(reset_line, 1);
         syslog(LOG_INFO, "测试模式: 引脚设置为高电平");
         
         /* 延时3秒 */
@@ -276,8 +434,8 @@ void *test_mode_thread(void *arg) {
         if (!test_running) break;
         
         /* 设置BOOT_PIN和RESET_PIN为低电平 */
-        gpiod_line_set_value(boot_line, 0);
-        gpiod_line_set_value(reset_line, 0);
+        gpio_set_value(boot_line, 0);
+        gpio_set_value(reset_line, 0);
         syslog(LOG_INFO, "测试模式: 引脚设置为低电平");
         
         /* 延时3秒 */
@@ -328,28 +486,493 @@ void exit_test_mode() {
 }
 
 /**
- * 处理RPC命令
+ * 计算两个时间点之间的毫秒数(b - a)
  */
-void handle_command(char *cmd, char *response) {
-    if (strcmp(cmd, "status") == 0) {
-        switch (current_state) {
-            case STATE_NORMAL:
-                strcpy(response, "STATUS:NORMAL");
-                break;
-            case STATE_RESET:
-                strcpy(response, "STATUS:RESET");
-                break;
-            case STATE_DFU:
-                strcpy(response, "STATUS:DFU");
-                break;
-            case STATE_TEST:
-                strcpy(response, "STATUS:TEST");
-                break;
-            default:
-                strcpy(response, "STATUS:UNKNOWN");
+static double timespec_diff_ms(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) * 1000.0 + (b->tv_nsec - a->tv_nsec) / 1000000.0;
+}
+
+/**
+ * 将波特率数值转换为termios常量，不支持时返回0
+ */
+static speed_t baud_to_speed(long baud) {
+    switch (baud) {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        default:      return 0;
+    }
+}
+
+/**
+ * 添加串口采集通道
+ * 格式: 名称:设备路径:波特率:就绪标志，例如 wheel:/dev/robotWheel:115200:READY
+ * 就绪标志位于最后，可以包含冒号
+ */
+int add_serial_channel(const char *spec) {
+    char buf[SERIAL_NAME_MAX + SERIAL_PATH_MAX + SERIAL_BANNER_MAX + 16];
+    char *name, *path, *baud_str, *banner, *end;
+    
+    if (serial_channel_count >= MAX_SERIAL_CHANNELS) {
+        fprintf(stderr, "串口通道数量超过上限 %d\n", MAX_SERIAL_CHANNELS);
+        return -1;
+    }
+    
+    if (strlen(spec) >= sizeof(buf)) {
+        fprintf(stderr, "串口参数过长: %s\n", spec);
+        return -1;
+    }
+    strcpy(buf, spec);
+    
+    /* 依次拆分出名称、路径和波特率，剩余部分为就绪标志 */
+    name = buf;
+    path = strchr(name, ':');
+    if (path) *path++ = '\0';
+    baud_str = path ? strchr(path, ':') : NULL;
+    if (baud_str) *baud_str++ = '\0';
+    banner = baud_str ? strchr(baud_str, ':') : NULL;
+    if (banner) *banner++ = '\0';
+    
+    if (!banner || !*name || !*path || !*banner) {
+        fprintf(stderr, "串口参数格式错误: %s (应为 名称:设备:波特率:就绪标志)\n", spec);
+        return -1;
+    }
+    if (strlen(name) >= SERIAL_NAME_MAX || strlen(path) >= SERIAL_PATH_MAX ||
+        strlen(banner) >= SERIAL_BANNER_MAX) {
+        fprintf(stderr, "串口参数字段过长: %s\n", spec);
+        return -1;
+    }
+    
+    speed_t speed = baud_to_speed(strtol(baud_str, &end, 10));
+    if (*end != '\0' || speed == 0) {
+        fprintf(stderr, "不支持的波特率: %s\n", baud_str);
+        return -1;
+    }
+    
+    struct serial_channel *ch = &serial_channels[serial_channel_count++];
+    memset(ch, 0, sizeof(*ch));
+    strcpy(ch->name, name);
+    strcpy(ch->path, path);
+    strcpy(ch->banner, banner);
+    ch->banner_len = strlen(banner);
+    ch->banner_fail[0] = 0;
+    for (size_t q = 1, k = 0; q < ch->banner_len; q++) {
+        while (k > 0 && banner[q] != banner[k])
+            k = ch->banner_fail[k - 1];
+        if (banner[q] == banner[k])
+            k++;
+        ch->banner_fail[q] = k;
+    }
+    ch->baud = speed;
+    ch->fd = -1;
+    ch->reopen_ms = -1;
+    return 0;
+}
+
+/**
+ * 监视各串口所在目录(通常为/dev)，udev创建设备节点或链接时立即重新打开
+ * 目录不存在或inotify不可用时退回按间隔重试
+ */
+void serial_watch_devices() {
+    if (serial_channel_count == 0)
+        return;
+    
+    serial_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (serial_inotify_fd < 0) {
+        syslog(LOG_WARNING, "inotify初始化失败: %s，串口按间隔重试打开", strerror(errno));
+        return;
+    }
+    
+    for (int i = 0; i < serial_channel_count; i++) {
+        char dir[SERIAL_PATH_MAX];
+        strcpy(dir, serial_channels[i].path);
+        char *slash = strrchr(dir, '/');
+        if (!slash)
+            strcpy(dir, ".");
+        else if (slash == dir)
+            dir[1] = '\0';
+        else
+            *slash = '\0';
+        /* 同一目录重复添加返回同一watch，无需去重 */
+        if (inotify_add_watch(serial_inotify_fd, dir, IN_CREATE | IN_ATTRIB | IN_MOVED_TO) < 0) {
+            syslog(LOG_WARNING, "无法监视目录 %s: %s", dir, strerror(errno));
         }
+    }
+}
+
+/**
+ * 串口是否处于复位后的快速重试期：设备不存在(拔出、路径错误)时只在复位后的
+ * 一段时间内快速重试，之后按普通间隔重试，更晚的重新枚举由inotify发现
+ */
+int serial_fast_reopen(const struct serial_channel *ch, const struct timespec *now) {
+    return ch->fd < 0 && ch->reset_pending &&
+           timespec_diff_ms(&ch->reset_ts, now) < SERIAL_FAST_REOPEN_WINDOW_MS;
+}
+
+/**
+ * 串口事件循环的poll超时：复位后有串口尚未重新出现时缩短超时，尽快重新打开
+ */
+int serial_poll_timeout() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    for (int i = 0; i < serial_channel_count; i++) {
+        if (serial_fast_reopen(&serial_channels[i], &now))
+            return SERIAL_FAST_REOPEN_MS;
+    }
+    return POLL_TIMEOUT_MS;
+}
+
+/**
+ * 打开尚未打开的串口（非阻塞、原始模式）
+ * 单片机复位时USB ACM设备会重新枚举：复位后的快速重试期内每次循环都重试，
+ * 其他情况按固定间隔重试；force为1时(设备目录有变化)立即重试
+ */
+void serial_open_channels(int force) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    for (int i = 0; i < serial_channel_count; i++) {
+        struct serial_channel *ch = &serial_channels[i];
+        if (ch->fd >= 0)
+            continue;
+        if (!force && !serial_fast_reopen(ch, &now) &&
+            (ch->last_open_try.tv_sec || ch->last_open_try.tv_nsec) &&
+            timespec_diff_ms(&ch->last_open_try, &now) < SERIAL_REOPEN_INTERVAL_MS)
+            continue;
+        ch->last_open_try = now;
+        
+        int fd = open(ch->path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+        if (fd < 0)
+            continue;
+        
+        struct termios tio;
+        if (tcgetattr(fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            cfsetispeed(&tio, ch->baud);
+            cfsetospeed(&tio, ch->baud);
+            tio.c_cflag |= CLOCAL | CREAD;
+            if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+                syslog(LOG_WARNING, "串口 %s 参数设置失败: %s", ch->path, strerror(errno));
+            }
+        }
+        
+        ch->fd = fd;
+        ch->partial_len = 0;
+        ch->banner_match = 0;
+        if (ch->reset_pending && !ch->reopened_since_reset) {
+            /* 记录复位后串口重新出现的时刻，此前单片机的输出已丢失 */
+            ch->reopened_since_reset = 1;
+            ch->reopen_ms = timespec_diff_ms(&ch->reset_ts, &now);
+            syslog(LOG_INFO, "串口通道 %s 复位后 %.1f ms 重新打开: %s",
+                   ch->name, ch->reopen_ms, ch->path);
+        } else {
+            syslog(LOG_INFO, "串口通道 %s 已打开: %s", ch->name, ch->path);
+        }
+    }
+}
+
+/**
+ * 将当前行写入环形缓冲区
+ */
+static void serial_commit_line(struct serial_channel *ch) {
+    struct serial_line *line = &ch->lines[ch->line_head];
+    memcpy(line->text, ch->partial, ch->partial_len);
+    line->text[ch->partial_len] = '\0';
+    line->ts = ch->partial_ts;
+    ch->line_head = (ch->line_head + 1) % SERIAL_RING_LINES;
+    if (ch->line_count < SERIAL_RING_LINES)
+        ch->line_count++;
+    ch->partial_len = 0;
+}
+
+/**
+ * 用一个新字节推进就绪标志匹配(KMP)，完整匹配时返回1
+ */
+static int serial_match_banner(struct serial_channel *ch, char c) {
+    while (ch->banner_match > 0 && c != ch->banner[ch->banner_match])
+        ch->banner_match = ch->banner_fail[ch->banner_match - 1];
+    if (c == ch->banner[ch->banner_match])
+        ch->banner_match++;
+    if (ch->banner_match == ch->banner_len) {
+        ch->banner_match = 0;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * 非阻塞读取串口数据，按行加时间戳存入环形缓冲区
+ * 复位后首次出现就绪标志时记录复位到就绪的耗时
+ */
+void serial_read_channel(struct serial_channel *ch) {
+    char buf[512];
+    
+    while (ch->fd >= 0) {
+        ssize_t n = read(ch->fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (n <= 0) {
+            /* 设备被拔出或单片机复位导致重新枚举 */
+            syslog(LOG_INFO, "串口通道 %s 已断开: %s", ch->name,
+                   n < 0 ? strerror(errno) : "EOF");
+            close(ch->fd);
+            ch->fd = -1;
+            break;
+        }
+        
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        
+        for (ssize_t i = 0; i < n; i++) {
+            char c = buf[i];
+            if (c == '\r')
+                continue;
+            if (c == '\n') {
+                serial_commit_line(ch);
+                ch->banner_match = 0;
+                continue;
+            }
+            if (ch->partial_len == 0)
+                ch->partial_ts = now;
+            ch->partial[ch->partial_len++] = c;
+            ch->partial[ch->partial_len] = '\0';
+            
+            /* 在当前行内逐字节匹配就绪标志，不必等待换行；
+             * 匹配状态在复位时清零，复位前收到的字节不参与匹配 */
+            if (ch->reset_pending && serial_match_banner(ch, c)) {
+                double ms = timespec_diff_ms(&ch->reset_ts, &now);
+                ch->latency_ms[ch->latency_head] = ms;
+                ch->latency_head = (ch->latency_head + 1) % SERIAL_LATENCY_SAMPLES;
+                if (ch->latency_count < SERIAL_LATENCY_SAMPLES)
+                    ch->latency_count++;
+                ch->ready_total++;
+                ch->reset_pending = 0;
+                syslog(LOG_INFO, "串口通道 %s 复位到就绪耗时 %.1f ms", ch->name, ms);
+            }
+            
+            if (ch->partial_len >= SERIAL_LINE_MAX - 1)
+                serial_commit_line(ch);
+        }
+    }
+}
+
+/**
+ * 记录复位时刻（复位引脚释放的时刻），用于统计启动耗时
+ */
+void serial_mark_reset() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    for (int i = 0; i < serial_channel_count; i++) {
+        struct serial_channel *ch = &serial_channels[i];
+        if (ch->reset_pending)
+            ch->missed_total++;
+        ch->reset_pending = 1;
+        ch->banner_match = 0;
+        ch->reset_ts = now;
+        ch->reopened_since_reset = 0;
+        ch->reopen_ms = -1;
+    }
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * 输出各通道复位到就绪耗时分布
+ * 格式: SERIAL:名称 n=样本数 min=.. p50=.. p95=.. max=.. ready=.. missed=.. pending=0|1 reopen=..;...
+ * reopen为最近一次复位后串口重新出现的耗时(ms)，串口未断开时为"-"
+ */
+void serial_format_stats(char *response, size_t len) {
+    size_t off = snprintf(response, len, "SERIAL:");
+    
+    if (serial_channel_count == 0) {
+        snprintf(response, len, "ERROR:NO_SERIAL_CHANNEL");
+        return;
+    }
+    
+    for (int i = 0; i < serial_channel_count && off < len; i++) {
+        struct serial_channel *ch = &serial_channels[i];
+        double sorted[SERIAL_LATENCY_SAMPLES];
+        int n = ch->latency_count;
+        char reopen[24] = "-";
+        
+        if (ch->reopen_ms >= 0)
+            snprintf(reopen, sizeof(reopen), "%.1f", ch->reopen_ms);
+        
+        memcpy(sorted, ch->latency_ms, n * sizeof(double));
+        qsort(sorted, n, sizeof(double), compare_double);
+        
+        if (n > 0) {
+            /* 最近秩法计算分位数 */
+            int p50 = (n * 50 + 99) / 100 - 1;
+            int p95 = (n * 95 + 99) / 100 - 1;
+            off += snprintf(response + off, len - off,
+                            "%s%s n=%d min=%.1f p50=%.1f p95=%.1f max=%.1f ready=%lu missed=%lu pending=%d reopen=%s",
+                            i ? ";" : "", ch->name, n, sorted[0], sorted[p50], sorted[p95],
+                            sorted[n - 1], ch->ready_total, ch->missed_total, ch->reset_pending,
+                            reopen);
+        } else {
+            off += snprintf(response + off, len - off,
+                            "%s%s n=0 ready=%lu missed=%lu pending=%d reopen=%s",
+                            i ? ";" : "", ch->name, ch->ready_total, ch->missed_total,
+                            ch->reset_pending, reopen);
+        }
+    }
+}
+
+/**
+ * 输出指定通道最近的串口行，每行前附单调时钟时间戳(秒)
+ * 只输出能放入响应缓冲区的最新若干行
+ */
+void serial_format_log(const char *name, char *response, size_t len) {
+    struct serial_channel *ch = NULL;
+    
+    for (int i = 0; i < serial_channel_count; i++) {
+        if (strcmp(serial_channels[i].name, name) == 0) {
+            ch = &serial_channels[i];
+            break;
+        }
+    }
+    if (!ch) {
+        snprintf(response, len, "ERROR:UNKNOWN_SERIAL_CHANNEL");
+        return;
+    }
+    
+    size_t off = snprintf(response, len, "SERIAL_LOG:%s\n", ch->name);
+    
+    /* 从最新一行向前估算能放下的行数，"[秒.毫秒] "前缀按24字节计 */
+    int count = 0;
+    size_t need = off;
+    while (count < ch->line_count) {
+        int idx = (ch->line_head - 1 - count + SERIAL_RING_LINES) % SERIAL_RING_LINES;
+        size_t line_len = strlen(ch->lines[idx].text) + 24;
+        if (need + line_len >= len)
+            break;
+        need += line_len;
+        count++;
+    }
+    
+    for (int k = count - 1; k >= 0 && off < len; k--) {
+        struct serial_line *line = &ch->lines[(ch->line_head - 1 - k + SERIAL_RING_LINES) % SERIAL_RING_LINES];
+        off += snprintf(response + off, len - off, "[%ld.%03ld] %s\n",
+                        (long)line->ts.tv_sec, line->ts.tv_nsec / 1000000, line->text);
+    }
+}
+
+/**
+ * 关闭所有串口
+ */
+void serial_close_channels() {
+    for (int i = 0; i < serial_channel_count; i++) {
+        if (serial_channels[i].fd >= 0) {
+            close(serial_channels[i].fd);
+            serial_channels[i].fd = -1;
+        }
+    }
+    if (serial_inotify_fd >= 0) {
+        close(serial_inotify_fd);
+        serial_inotify_fd = -1;
+    }
+}
+
+/**
+ * 格式化当前状态
+ */
+void format_status(char *response) {
+    switch (current_state) {
+        case STATE_NORMAL:
+            strcpy(response, "STATUS:NORMAL");
+            break;
+        case STATE_RESET:
+            strcpy(response, "STATUS:RESET");
+            break;
+        case STATE_DFU:
+            strcpy(response, "STATUS:DFU");
+            break;
+        case STATE_TEST:
+            strcpy(response, "STATUS:TEST");
+            break;
+        default:
+            strcpy(response, "STATUS:UNKNOWN");
+    }
+}
+
+/**
+ * 格式化RPC服务统计
+ * 格式: METRICS:acceptors=N connections=N rejected=N queries=N commands=N
+ *       queue=N executed=N uptime_s=N per_acceptor=q0/q1/...
+ */
+void format_metrics(char *response, size_t len) {
+    unsigned long connections = 0, rejected = 0, queries = 0, commands = 0;
+    char per_acceptor[MAX_ACCEPTORS * 21] = "";
+    size_t pos = 0;
+    
+    for (int i = 0; i < acceptor_count; i++) {
+        struct rpc_acceptor *acc = &acceptors[i];
+        unsigned long q = __atomic_load_n(&acc->queries, __ATOMIC_RELAXED);
+        connections += __atomic_load_n(&acc->connections, __ATOMIC_RELAXED);
+        rejected += __atomic_load_n(&acc->rejected, __ATOMIC_RELAXED);
+        commands += __atomic_load_n(&acc->commands, __ATOMIC_RELAXED);
+        queries += q;
+        pos += snprintf(per_acceptor + pos, sizeof(per_acceptor) - pos, "%s%lu", i ? "/" : "", q);
+    }
+    
+    pthread_mutex_lock(&exec_lock);
+    int queue = exec_queue_len;
+    pthread_mutex_unlock(&exec_lock);
+    
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    snprintf(response, len,
+             "METRICS:acceptors=%d connections=%lu rejected=%lu queries=%lu commands=%lu "
+             "queue=%d executed=%lu uptime_s=%ld per_acceptor=%s",
+             acceptor_count, connections, rejected, queries, commands,
+             queue, __atomic_load_n(&exec_total, __ATOMIC_RELAXED),
+             (long)(now.tv_sec - start_time.tv_sec), per_acceptor);
+}
+
+/**
+ * 处理只读查询，可在任意接收线程中并发执行
+ * 返回1表示已处理，0表示需要交给GPIO执行器
+ */
+int handle_query(const char *cmd, char *response) {
+    if (strcmp(cmd, "status") == 0) {
+        format_status(response);
+    } else if (strcmp(cmd, "metrics") == 0) {
+        format_metrics(response, BUFFER_SIZE);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * 处理RPC命令，只在GPIO执行器(主线程)中调用
+ */
+void handle_command(char *cmd, char *response) {
+    if (handle_query(cmd, response)) {
+        return;
     } else if (strcmp(cmd, "normal") == 0) {
+        /* 从DFU模式退出时同样开始统计启动耗时 */
+        int was_dfu = (current_state == STATE_DFU);
         set_normal_state();
+        if (was_dfu) {
+            serial_mark_reset();
+        }
         strcpy(response, "OK:NORMAL");
     } else if (strcmp(cmd, "reset") == 0) {
         reset_mcu();
@@ -363,23 +986,378 @@ void handle_command(char *cmd, char *response) {
     } else if (strcmp(cmd, "test_exit") == 0) {
         exit_test_mode();
         strcpy(response, "OK:TEST_EXIT");
+    } else if (strcmp(cmd, "serial_stats") == 0) {
+        serial_format_stats(response, BUFFER_SIZE);
+    } else if (strncmp(cmd, "serial_log ", 11) == 0) {
+        serial_format_log(cmd + 11, response, BUFFER_SIZE);
     } else {
         strcpy(response, "ERROR:UNKNOWN_COMMAND");
     }
 }
 
 /**
- * 启动RPC服务器
+ * 唤醒等待在管道上的线程
  */
-int start_rpc_server() {
-    int server_fd, client_fd;
-    struct sockaddr_in server_addr, client_addr;
+static void wake_pipe_write(int fd) {
+    char c = 1;
+    /* 管道已满说明对方尚未处理，无需重复唤醒 */
+    if (write(fd, &c, 1) < 0 && errno != EAGAIN) {
+        syslog(LOG_ERR, "唤醒线程失败: %s", strerror(errno));
+    }
+}
+
+/**
+ * 清空唤醒管道
+ */
+static void wake_pipe_drain(int fd) {
+    char buf[64];
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+}
+
+/**
+ * 创建非阻塞唤醒管道
+ */
+static int wake_pipe_open(int fds[2]) {
+    if (pipe(fds) < 0) {
+        syslog(LOG_ERR, "创建管道失败: %s", strerror(errno));
+        return -1;
+    }
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    return 0;
+}
+
+/**
+ * 将命令提交给GPIO执行器，由接收线程调用
+ */
+void executor_submit(struct rpc_client *client) {
+    client->busy = 1;
+    client->next = NULL;
+    
+    pthread_mutex_lock(&exec_lock);
+    if (exec_tail)
+        exec_tail->next = client;
+    else
+        exec_head = client;
+    exec_tail = client;
+    exec_queue_len++;
+    pthread_mutex_unlock(&exec_lock);
+    
+    wake_pipe_write(exec_pipe[1]);
+}
+
+/**
+ * 依次执行队列中的命令，并把结果交回各自的接收线程
+ */
+void executor_run_queue() {
+    while (running) {
+        pthread_mutex_lock(&exec_lock);
+        struct rpc_client *client = exec_head;
+        if (client) {
+            exec_head = client->next;
+            if (!exec_head)
+                exec_tail = NULL;
+            exec_queue_len--;
+        }
+        pthread_mutex_unlock(&exec_lock);
+        
+        if (!client)
+            break;
+        
+        syslog(LOG_INFO, "收到命令: %s", client->cmd);
+        memset(client->response, 0, sizeof(client->response));
+        handle_command(client->cmd, client->response);
+        __atomic_fetch_add(&exec_total, 1, __ATOMIC_RELAXED);
+        
+        struct rpc_acceptor *acc = client->owner;
+        client->next = NULL;
+        pthread_mutex_lock(&acc->done_lock);
+        if (acc->done_tail)
+            acc->done_tail->next = client;
+        else
+            acc->done_head = client;
+        acc->done_tail = client;
+        pthread_mutex_unlock(&acc->done_lock);
+        
+        wake_pipe_write(acc->wake_pipe[1]);
+    }
+}
+
+/**
+ * 完整写出数据
+ */
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * 向客户端发送响应，行模式下多行响应(如serial_log)以制表符分隔并以换行结尾
+ */
+static int rpc_client_reply(struct rpc_client *client, char *response) {
+    size_t len = strlen(response);
+    if (client->line_mode) {
+        for (size_t i = 0; i < len; i++) {
+            if (response[i] == '\n')
+                response[i] = '\t';
+        }
+        response[len++] = '\n';
+    }
+    if (write_all(client->fd, response, len) < 0) {
+        syslog(LOG_ERR, "发送响应失败: %s", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 分发一条命令：只读查询直接应答，其余命令提交给执行器
+ * 返回0表示已应答，1表示已提交执行器，-1表示需要关闭连接
+ */
+static int rpc_client_dispatch(struct rpc_client *client, const char *cmd) {
+    char response[BUFFER_SIZE + 1];
+    
+    memset(response, 0, sizeof(response));
+    if (handle_query(cmd, response)) {
+        syslog(LOG_DEBUG, "收到查询: %s", cmd);
+        __atomic_fetch_add(&client->owner->queries, 1, __ATOMIC_RELAXED);
+        return rpc_client_reply(client, response);
+    }
+    
+    __atomic_fetch_add(&client->owner->commands, 1, __ATOMIC_RELAXED);
+    snprintf(client->cmd, sizeof(client->cmd), "%s", cmd);
+    executor_submit(client);
+    return 1;
+}
+
+/**
+ * 处理缓冲区中每个完整的命令行，遇到需要执行器处理的命令时暂停
+ * 返回0表示保持连接，-1表示需要关闭连接
+ */
+int rpc_client_process(struct rpc_client *client) {
+    char *start = client->buf;
+    char *nl;
+    while (!client->busy &&
+           (nl = memchr(start, '\n', client->buf + client->len - start)) != NULL) {
+        *nl = '\0';
+        if (nl > start && nl[-1] == '\r')
+            nl[-1] = '\0';
+        
+        if (*start && rpc_client_dispatch(client, start) < 0) {
+            return -1;
+        }
+        start = nl + 1;
+    }
+    
+    client->len -= start - client->buf;
+    memmove(client->buf, start, client->len);
+    
+    if (!client->busy && client->len >= BUFFER_SIZE - 1) {
+        write_all(client->fd, "ERROR:LINE_TOO_LONG\n", 20);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 读取客户端数据并处理其中的命令
+ * 返回0表示保持连接，-1表示需要关闭连接
+ */
+int rpc_client_read(struct rpc_client *client) {
+    ssize_t n = read(client->fd, client->buf + client->len, BUFFER_SIZE - 1 - client->len);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return 0;
+    }
+    if (n < 0) {
+        syslog(LOG_ERR, "读取数据失败: %s", strerror(errno));
+        return -1;
+    }
+    if (n == 0) {
+        return -1;
+    }
+    
+    int first_read = (client->len == 0 && !client->line_mode);
+    client->len += n;
+    client->buf[client->len] = '\0';
+    
+    /* 旧协议：单条命令不带换行，处理后关闭连接 */
+    if (first_read && !memchr(client->buf, '\n', client->len)) {
+        client->close_after = 1;
+        client->len = 0;
+        return rpc_client_dispatch(client, client->buf) == 1 ? 0 : -1;
+    }
+    client->line_mode = 1;
+    
+    return rpc_client_process(client);
+}
+
+/**
+ * 关闭客户端连接并释放槽位
+ */
+static void rpc_client_close(struct rpc_client *client) {
+    close(client->fd);
+    client->fd = -1;
+    client->owner->client_count--;
+}
+
+/**
+ * 接受所有等待中的连接
+ */
+static void acceptor_accept(struct rpc_acceptor *acc) {
+    struct sockaddr_in client_addr;
     socklen_t client_len;
-    char buffer[BUFFER_SIZE];
-    char response[BUFFER_SIZE];
+    
+    while (1) {
+        client_len = sizeof(client_addr);
+        int client_fd = accept(acc->listen_fd, (struct sockaddr *)&client_addr, &client_len);
+        
+        if (client_fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                syslog(LOG_ERR, "接受连接失败: %s", strerror(errno));
+            }
+            break;
+        }
+        
+        syslog(LOG_DEBUG, "接收线程%d 接受来自 %s:%d 的连接", acc->id,
+               inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
+        
+        int slot = -1;
+        if (acc->client_count < MAX_RPC_CLIENTS) {
+            for (int i = 0; i < MAX_RPC_CLIENTS; i++) {
+                if (acc->clients[i].fd < 0) {
+                    slot = i;
+                    break;
+                }
+            }
+        }
+        if (slot < 0) {
+            syslog(LOG_WARNING, "接收线程%d 客户端连接数已达上限 %d，拒绝连接",
+                   acc->id, MAX_RPC_CLIENTS);
+            __atomic_fetch_add(&acc->rejected, 1, __ATOMIC_RELAXED);
+            close(client_fd);
+            continue;
+        }
+        
+        struct rpc_client *client = &acc->clients[slot];
+        client->fd = client_fd;
+        client->line_mode = 0;
+        client->busy = 0;
+        client->close_after = 0;
+        client->len = 0;
+        acc->client_count++;
+        __atomic_fetch_add(&acc->connections, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * 发送执行器完成的响应，并继续处理该连接缓冲区中剩余的命令
+ */
+static void acceptor_complete(struct rpc_acceptor *acc) {
+    pthread_mutex_lock(&acc->done_lock);
+    struct rpc_client *client = acc->done_head;
+    acc->done_head = acc->done_tail = NULL;
+    pthread_mutex_unlock(&acc->done_lock);
+    
+    while (client) {
+        struct rpc_client *next = client->next;
+        client->busy = 0;
+        if (rpc_client_reply(client, client->response) < 0 || client->close_after ||
+            rpc_client_process(client) < 0) {
+            rpc_client_close(client);
+        }
+        client = next;
+    }
+}
+
+/**
+ * 接收线程：接受连接、读取命令、应答只读查询
+ * 等待执行器的连接不参与poll，避免对端关闭时poll反复返回
+ */
+void *acceptor_thread(void *arg) {
+    struct rpc_acceptor *acc = arg;
+    struct pollfd fds[2 + MAX_RPC_CLIENTS];
+    int fd_owner[2 + MAX_RPC_CLIENTS];
+    
+    while (running) {
+        int nfds = 0;
+        fds[nfds].fd = acc->wake_pipe[0];
+        fds[nfds].events = POLLIN;
+        fds[nfds].revents = 0;
+        nfds++;
+        /* 连接数已满时不再接受连接，新连接留在内核监听队列中 */
+        int listen_idx = -1;
+        if (acc->client_count < MAX_RPC_CLIENTS) {
+            listen_idx = nfds;
+            fds[nfds].fd = acc->listen_fd;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            nfds++;
+        }
+        int client_start = nfds;
+        for (int i = 0; i < MAX_RPC_CLIENTS; i++) {
+            if (acc->clients[i].fd < 0 || acc->clients[i].busy)
+                continue;
+            fds[nfds].fd = acc->clients[i].fd;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            fd_owner[nfds] = i;
+            nfds++;
+        }
+        
+        if (poll(fds, nfds, POLL_TIMEOUT_MS) < 0) {
+            if (errno != EINTR) {
+                syslog(LOG_ERR, "poll失败: %s", strerror(errno));
+                usleep(100000);  // 100ms
+            }
+            continue;
+        }
+        
+        if (fds[0].revents) {
+            wake_pipe_drain(acc->wake_pipe[0]);
+            acceptor_complete(acc);
+        }
+        
+        for (int k = client_start; k < nfds; k++) {
+            if (!fds[k].revents)
+                continue;
+            struct rpc_client *client = &acc->clients[fd_owner[k]];
+            if (client->fd >= 0 && rpc_client_read(client) < 0) {
+                rpc_client_close(client);
+            }
+        }
+        
+        if (listen_idx >= 0 && (fds[listen_idx].revents & POLLIN)) {
+            acceptor_accept(acc);
+        }
+    }
+    
+    /* 关闭客户端连接 */
+    for (int i = 0; i < MAX_RPC_CLIENTS; i++) {
+        if (acc->clients[i].fd >= 0) {
+            rpc_client_close(&acc->clients[i]);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 创建监听套接字，所有接收线程通过SO_REUSEPORT绑定同一端口，由内核分配连接
+ */
+static int create_listen_socket() {
+    struct sockaddr_in server_addr;
     
     /* 创建套接字 */
-    server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (server_fd < 0) {
         syslog(LOG_ERR, "无法创建套接字: %s", strerror(errno));
         return -1;
@@ -387,7 +1365,8 @@ int start_rpc_server() {
     
     /* 设置套接字选项 */
     int opt = 1;
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
         syslog(LOG_ERR, "设置套接字选项失败: %s", strerror(errno));
         close(server_fd);
         return -1;
@@ -397,7 +1376,7 @@ int start_rpc_server() {
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(RPC_PORT);
+    server_addr.sin_port = htons(rpc_port);
     
     /* 绑定地址 */
     if (bind(server_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
@@ -407,62 +1386,145 @@ int start_rpc_server() {
     }
     
     /* 监听连接 */
-    if (listen(server_fd, 5) < 0) {
+    if (listen(server_fd, RPC_BACKLOG) < 0) {
         syslog(LOG_ERR, "监听失败: %s", strerror(errno));
         close(server_fd);
         return -1;
     }
     
-    syslog(LOG_NOTICE, "RPC服务器已启动，监听端口 %d", RPC_PORT);
-    
     /* 设置非阻塞模式 */
     fcntl(server_fd, F_SETFL, O_NONBLOCK);
+    return server_fd;
+}
+
+/**
+ * 释放接收线程资源
+ */
+static void acceptor_cleanup(struct rpc_acceptor *acc) {
+    if (acc->listen_fd >= 0)
+        close(acc->listen_fd);
+    if (acc->wake_pipe[0] >= 0)
+        close(acc->wake_pipe[0]);
+    if (acc->wake_pipe[1] >= 0)
+        close(acc->wake_pipe[1]);
+    pthread_mutex_destroy(&acc->done_lock);
+    free(acc->clients);
+}
+
+/**
+ * 启动RPC服务器
+ * 创建接收线程后，主线程作为GPIO执行器：串行执行命令并采集串口数据
+ */
+int start_rpc_server() {
+    int started = 0;
+    int ret = 0;
     
-    /* 主循环 */
+    if (wake_pipe_open(exec_pipe) < 0) {
+        return -1;
+    }
+    
+    /* 先创建全部监听套接字，端口不可用时直接失败 */
+    for (int i = 0; i < acceptor_count; i++) {
+        struct rpc_acceptor *acc = &acceptors[i];
+        memset(acc, 0, sizeof(*acc));
+        acc->id = i;
+        acc->wake_pipe[0] = acc->wake_pipe[1] = -1;
+        pthread_mutex_init(&acc->done_lock, NULL);
+        acc->clients = calloc(MAX_RPC_CLIENTS, sizeof(struct rpc_client));
+        acc->listen_fd = create_listen_socket();
+        started = i + 1;
+        if (!acc->clients || acc->listen_fd < 0 || wake_pipe_open(acc->wake_pipe) < 0) {
+            ret = -1;
+            goto cleanup;
+        }
+        for (int j = 0; j < MAX_RPC_CLIENTS; j++) {
+            acc->clients[j].fd = -1;
+            acc->clients[j].owner = acc;
+        }
+    }
+    
+    for (int i = 0; i < acceptor_count; i++) {
+        if (pthread_create(&acceptors[i].thread, NULL, acceptor_thread, &acceptors[i]) != 0) {
+            syslog(LOG_ERR, "创建接收线程失败: %s", strerror(errno));
+            running = 0;
+            for (int j = 0; j < i; j++)
+                pthread_join(acceptors[j].thread, NULL);
+            ret = -1;
+            goto cleanup;
+        }
+    }
+    
+    syslog(LOG_NOTICE, "RPC服务器已启动，监听端口 %d，接收线程 %d 个，监听队列 %d",
+           rpc_port, acceptor_count, RPC_BACKLOG);
+    
+    /* 执行器循环：同时等待提交的命令、串口数据和设备目录变化 */
+    struct pollfd fds[2 + MAX_SERIAL_CHANNELS];
+    int fd_owner[2 + MAX_SERIAL_CHANNELS];
+    serial_watch_devices();
     while (running) {
-        /* 接受连接 */
-        client_len = sizeof(client_addr);
-        client_fd = accept(server_fd, (struct sockaddr *)&client_addr, &client_len);
+        serial_open_channels(0);
         
-        if (client_fd < 0) {
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                syslog(LOG_ERR, "接受连接失败: %s", strerror(errno));
-            }
-            usleep(100000);  // 100ms
-            continue;
+        int nfds = 0;
+        fds[nfds].fd = exec_pipe[0];
+        fds[nfds].events = POLLIN;
+        fds[nfds].revents = 0;
+        nfds++;
+        fds[nfds].fd = serial_inotify_fd;   // 为-1时poll忽略该项
+        fds[nfds].events = POLLIN;
+        fds[nfds].revents = 0;
+        nfds++;
+        for (int i = 0; i < serial_channel_count; i++) {
+            if (serial_channels[i].fd < 0)
+                continue;
+            fds[nfds].fd = serial_channels[i].fd;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            fd_owner[nfds] = i;
+            nfds++;
         }
         
-        syslog(LOG_INFO, "接受来自 %s:%d 的连接", 
-               inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
-        
-        /* 接收命令 */
-        memset(buffer, 0, BUFFER_SIZE);
-        int n = read(client_fd, buffer, BUFFER_SIZE - 1);
-        if (n < 0) {
-            syslog(LOG_ERR, "读取数据失败: %s", strerror(errno));
-            close(client_fd);
+        if (poll(fds, nfds, serial_poll_timeout()) < 0) {
+            if (errno != EINTR) {
+                syslog(LOG_ERR, "poll失败: %s", strerror(errno));
+                usleep(100000);  // 100ms
+            }
             continue;
         }
         
-        buffer[n] = '\0';
-        syslog(LOG_INFO, "收到命令: %s", buffer);
-        
-        /* 处理命令 */
-        memset(response, 0, BUFFER_SIZE);
-        handle_command(buffer, response);
+        /* 设备节点出现后立即打开，减少重新枚举期间丢失的串口输出 */
+        if (fds[1].revents) {
+            char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+            while (read(serial_inotify_fd, events, sizeof(events)) > 0)
+                ;
+            serial_open_channels(1);
+        }
         
-        /* 发送响应 */
-        if (write(client_fd, response, strlen(response)) < 0) {
-            syslog(LOG_ERR, "发送响应失败: %s", strerror(errno));
+        /* 先读取串口，保证时间戳尽量接近数据到达时刻 */
+        for (int k = 2; k < nfds; k++) {
+            if (fds[k].revents) {
+                serial_read_channel(&serial_channels[fd_owner[k]]);
+            }
         }
         
-        /* 关闭连接 */
-        close(client_fd);
+        if (fds[0].revents) {
+            wake_pipe_drain(exec_pipe[0]);
+            executor_run_queue();
+        }
     }
     
-    /* 关闭服务器套接字 */
-    close(server_fd);
-    return 0;
+    /* 等待接收线程退出，之后不再有线程访问客户端表 */
+    for (int i = 0; i < acceptor_count; i++) {
+        pthread_join(acceptors[i].thread, NULL);
+    }
+    
+cleanup:
+    for (int i = 0; i < started; i++) {
+        acceptor_cleanup(&acceptors[i]);
+    }
+    close(exec_pipe[0]);
+    close(exec_pipe[1]);
+    serial_close_channels();
+    return ret;
 }
 
 /**
@@ -471,17 +1533,48 @@ int start_rpc_server() {
 int main(int argc, char *argv[]) {
     /* 检查是否以守护进程模式运行 */
     int daemon_mode = 1;
+    int verbose = 0;
     
     /* 解析命令行参数 */
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--foreground") == 0) {
             daemon_mode = 0;
+        } else if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--mock") == 0) {
+            mock_gpio = 1;
+        } else if ((strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--port") == 0) && i + 1 < argc) {
+            rpc_port = atoi(argv[++i]);
+            if (rpc_port <= 0 || rpc_port > 65535) {
+                fprintf(stderr, "无效的端口: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if ((strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--acceptors") == 0) && i + 1 < argc) {
+            acceptor_count = atoi(argv[++i]);
+            if (acceptor_count <= 0 || acceptor_count > MAX_ACCEPTORS) {
+                fprintf(stderr, "无效的接收线程数: %s (1-%d)\n", argv[i], MAX_ACCEPTORS);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+            /* 记录每个连接和只读查询，高频查询时会显著降低吞吐 */
+            verbose = 1;
+        } else if ((strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--serial") == 0) && i + 1 < argc) {
+            /* 串口采集通道: 名称:设备:波特率:就绪标志 */
+            if (add_serial_channel(argv[++i]) < 0) {
+                exit(EXIT_FAILURE);
+            }
         }
     }
     
+    /* 默认每个CPU核一个接收线程 */
+    if (acceptor_count == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        acceptor_count = cpus < 1 ? 1 : (cpus > MAX_ACCEPTORS ? MAX_ACCEPTORS : (int)cpus);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    
     /* 设置信号处理 */
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    signal(SIGPIPE, SIG_IGN);  // 客户端提前断开时write返回错误而不是终止进程
     
     /* 以守护进程模式运行 */
     if (daemon_mode) {
@@ -491,6 +1584,7 @@ int main(int argc, char *argv[]) {
         openlog("gpio_daemon", LOG_PID, LOG_USER);
     }
     
+    setlogmask(LOG_UPTO(verbose ? LOG_DEBUG : LOG_INFO));
     syslog(LOG_NOTICE, "GPIO守护进程启动");
     
     /* 初始化GPIO */
@@ -0,0 +1,707 @@
+/**
+ * gpio_gateway.c - 多开发板GPIO守护进程网关，用于整个测试台的并发复位和DFU
+ *
+ * 功能：
+ * 1. 从配置文件读取开发板列表（名称、地址、端口、分组），地址只解析一次
+ * 2. 每块板一个 gpio_client（连接池大小1），与gpio_daemon保持持久连接，断开后按需重连
+ * 3. 将一条命令并发下发到一个分组/单块板/全部开发板，汇总每块板的结果和耗时
+ * 4. 每块板独立超时，某块板无响应不会拖住其他板
+ * 5. 服务模式下不同客户端的请求只要目标开发板不重叠就并发执行，
+ *    重叠时按到达顺序排队；同一客户端的请求按顺序执行
+ * 6. 客户端的请求执行期间不读取该客户端，流水线发送的请求由内核缓冲区反压；
+ *    客户端半关闭后仍执行完已发送的请求并返回结果，再关闭连接
+ *
+ * 编译：make gpio_gateway
+ * 运行：./gpio_gateway -b boards.conf -c "bench1 reset"     单次执行后退出
+ *       ./gpio_gateway -b boards.conf -l 8889              网关服务模式
+ *
+ * 配置文件每行一块板：名称 主机 端口 [分组1,分组2,...]，#开头为注释
+ *
+ * 请求格式（单次执行和服务模式相同）：<目标> <命令>
+ *   目标为 all、分组名或开发板名称，命令为gpio_daemon支持的任意命令
+ * 响应格式：
+ *   RESULT target=bench1 cmd=reset boards=3 ok=2 fail=1 elapsed_ms=305.4
+ *   board01 OK:RESET 301.2
+ *   board02 OK:RESET 305.1
+ *   board03 ERROR:TIMEOUT 2000.0
+ *   END
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "gpio_client.h"
+
+#define BUFFER_SIZE        1024
+#define MAX_BOARDS         256
+#define MAX_CLIENTS        32
+#define NAME_MAX_LEN       32
+#define HOST_MAX_LEN       64
+#define GROUPS_MAX_LEN     128
+#define DEFAULT_TIMEOUT_MS 2000
+#define IDLE_POLL_MS       1000
+#define RESOLVE_RETRY_MS   30000       // 重新解析启动时解析失败的开发板的间隔
+
+/* 开发板 */
+struct board {
+    char name[NAME_MAX_LEN];
+    char host[HOST_MAX_LEN];
+    char port[8];
+    char groups[GROUPS_MAX_LEN];        // 逗号分隔的分组列表
+    gpio_client *client;                // 与该板gpio_daemon的连接，连接池大小1
+    struct timespec resolve_ts;         // 最近一次解析地址的时间
+
+    /* 占用该板的请求，请求完成并返回结果后才释放 */
+    int owner;                          // 请求下标，-1表示空闲
+    int done;
+    struct timespec start;
+    double latency_ms;
+    char result[BUFFER_SIZE];
+};
+
+/* 网关服务模式下的客户端 */
+struct client {
+    int fd;
+    char buf[BUFFER_SIZE];
+    size_t len;
+    int eof;                            // 对端已半关闭，不再读取，处理完已收到的请求后关闭
+    int discard;                        // 正在丢弃过长的请求行，直到下一个换行
+};
+
+/* 请求状态 */
+#define JOB_IDLE    0
+#define JOB_WAITING 1                   // 已解析，等待目标开发板空闲
+#define JOB_RUNNING 2
+
+/* 请求，每个客户端同时最多一个，下标与客户端相同 */
+struct job {
+    int state;
+    int client;                         // 发起请求的客户端下标，-1表示单次执行模式
+    unsigned long seq;                  // 到达顺序，等待中的请求按此顺序占用开发板
+    char target[NAME_MAX_LEN];
+    char cmd[BUFFER_SIZE];
+    struct timespec start;
+    int pending;                        // 尚未完成的开发板数
+};
+
+static volatile int running = 1;
+static struct board boards[MAX_BOARDS];
+static int board_count = 0;
+static struct client clients[MAX_CLIENTS];
+static struct job jobs[MAX_CLIENTS];
+static unsigned long job_seq = 0;
+static int timeout_ms = DEFAULT_TIMEOUT_MS;
+
+static void signal_handler(int signo) {
+    (void)signo;
+    running = 0;
+}
+
+static double elapsed_ms(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) * 1000.0 + (b->tv_nsec - a->tv_nsec) / 1000000.0;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "用法: %s -b boards.conf [-t timeout_ms] (-c \"目标 命令\" | -l port)\n"
+            "  -b file     开发板配置文件（每行: 名称 主机 端口 [分组1,分组2]）\n"
+            "  -t ms       每块板的超时时间，默认: %d\n"
+            "  -c request  单次执行请求后退出，如 \"bench1 reset\"\n"
+            "  -l port     网关服务模式，监听指定端口接收请求\n"
+            "目标可以是 all、分组名或开发板名称。\n",
+            prog, DEFAULT_TIMEOUT_MS);
+}
+
+/**
+ * 读取开发板配置文件
+ */
+static int load_boards(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "无法打开配置文件 %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    char line[BUFFER_SIZE];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+
+        char name[NAME_MAX_LEN], host[HOST_MAX_LEN], port[8], groups[GROUPS_MAX_LEN];
+        groups[0] = '\0';
+        int n = sscanf(line, "%31s %63s %7s %127s", name, host, port, groups);
+        if (n <= 0)
+            continue;
+        if (n < 3) {
+            fprintf(stderr, "%s:%d: 格式错误，应为: 名称 主机 端口 [分组]\n", path, lineno);
+            fclose(fp);
+            return -1;
+        }
+        if (board_count >= MAX_BOARDS) {
+            fprintf(stderr, "开发板数量超过上限 %d\n", MAX_BOARDS);
+            fclose(fp);
+            return -1;
+        }
+
+        struct board *b = &boards[board_count++];
+        memset(b, 0, sizeof(*b));
+        strcpy(b->name, name);
+        strcpy(b->host, host);
+        strcpy(b->port, port);
+        strcpy(b->groups, groups);
+        b->owner = -1;
+        /* 解析会阻塞，启动时完成；失败不影响其他板，请求时立即返回ERROR:RESOLVE */
+        b->client = gpio_client_new(host, port, 1);
+        if (!b->client) {
+            fprintf(stderr, "%s: 无法创建客户端 %s:%s\n", name, host, port);
+            fclose(fp);
+            return -1;
+        }
+        gpio_client_set_timeout(b->client, timeout_ms);
+        clock_gettime(CLOCK_MONOTONIC, &b->resolve_ts);
+        if (!gpio_client_resolved(b->client))
+            fprintf(stderr, "%s: 无法解析 %s:%s，请求将返回ERROR:RESOLVE\n", name, host, port);
+    }
+
+    fclose(fp);
+    if (board_count == 0) {
+        fprintf(stderr, "配置文件 %s 中没有开发板\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 判断开发板是否属于目标（all、分组名或开发板名称）
+ */
+static int board_matches(const struct board *b, const char *target) {
+    if (strcmp(target, "all") == 0 || strcmp(target, b->name) == 0)
+        return 1;
+
+    size_t len = strlen(target);
+    const char *p = b->groups;
+    while (*p) {
+        const char *end = strchr(p, ',');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        if (n == len && strncmp(p, target, n) == 0)
+            return 1;
+        if (!end)
+            break;
+        p = end + 1;
+    }
+    return 0;
+}
+
+/**
+ * 记录开发板结果
+ */
+static void board_finish(struct board *b, const char *result) {
+    struct timespec now;
+
+    if (b->owner < 0 || b->done)
+        return;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    snprintf(b->result, sizeof(b->result), "%s", result);
+    b->latency_ms = elapsed_ms(&b->start, &now);
+    b->done = 1;
+    jobs[b->owner].pending--;
+}
+
+/**
+ * 将客户端库的错误码转换为结果字符串
+ */
+static const char *status_result(int status) {
+    switch (status) {
+        case GPIO_CLIENT_ERR_CONNECT: return "ERROR:CONNECT";
+        case GPIO_CLIENT_ERR_IO:      return "ERROR:DISCONNECTED";
+        case GPIO_CLIENT_ERR_TIMEOUT: return "ERROR:TIMEOUT";
+        case GPIO_CLIENT_ERR_CLOSED:  return "ERROR:CLOSED";
+        case GPIO_CLIENT_ERR_FULL:    return "ERROR:BUSY";
+        case GPIO_CLIENT_ERR_RESOLVE: return "ERROR:RESOLVE";
+        default:                      return "ERROR:UNKNOWN";
+    }
+}
+
+/**
+ * 开发板响应回调，超时或断开时客户端库会关闭连接，下次请求时重连
+ */
+static void board_reply(void *arg, int status, const char *response) {
+    struct board *b = arg;
+    board_finish(b, status == GPIO_CLIENT_OK ? response : status_result(status));
+}
+
+/**
+ * 解析请求，返回目标开发板数量，格式错误返回-1；有目标时请求进入等待状态
+ */
+static int job_parse(struct job *j, int client, const char *request) {
+    char target[NAME_MAX_LEN];
+    int consumed = 0;
+
+    if (sscanf(request, " %31s %n", target, &consumed) != 1 || request[consumed] == '\0')
+        return -1;
+
+    memset(j, 0, sizeof(*j));
+    j->client = client;
+    strcpy(j->target, target);
+    snprintf(j->cmd, sizeof(j->cmd), "%s", request + consumed);
+
+    int total = 0;
+    for (int i = 0; i < board_count; i++) {
+        if (board_matches(&boards[i], target))
+            total++;
+    }
+    if (total > 0) {
+        j->state = JOB_WAITING;
+        j->seq = ++job_seq;
+    }
+    return total;
+}
+
+/**
+ * 判断请求的目标开发板是否都空闲且未被更早的请求预留
+ */
+static int job_ready(const struct job *j, const char *reserved) {
+    for (int i = 0; i < board_count; i++) {
+        if (board_matches(&boards[i], j->target) && (boards[i].owner >= 0 || reserved[i]))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * 占用目标开发板并下发命令
+ */
+static void job_start(struct job *j) {
+    int idx = j - jobs;
+
+    j->state = JOB_RUNNING;
+    clock_gettime(CLOCK_MONOTONIC, &j->start);
+
+    for (int i = 0; i < board_count; i++) {
+        struct board *b = &boards[i];
+        if (!board_matches(b, j->target))
+            continue;
+        b->owner = idx;
+        b->done = 0;
+        b->result[0] = '\0';
+        b->start = j->start;
+        j->pending++;
+    }
+
+    for (int i = 0; i < board_count; i++) {
+        struct board *b = &boards[i];
+        if (b->owner != idx)
+            continue;
+        int ret = gpio_client_submit(b->client, j->cmd, board_reply, b);
+        if (ret < 0)
+            board_finish(b, status_result(ret));
+    }
+}
+
+/**
+ * 汇总请求结果
+ */
+static void job_format(const struct job *j, FILE *out) {
+    struct timespec now;
+    int idx = j - jobs;
+    int total = 0, ok = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for (int i = 0; i < board_count; i++) {
+        if (boards[i].owner != idx)
+            continue;
+        total++;
+        if (strncmp(boards[i].result, "ERROR", 5) != 0)
+            ok++;
+    }
+
+    fprintf(out, "RESULT target=%s cmd=%s boards=%d ok=%d fail=%d elapsed_ms=%.1f\n",
+            j->target, j->cmd, total, ok, total - ok, elapsed_ms(&j->start, &now));
+    for (int i = 0; i < board_count; i++) {
+        if (boards[i].owner == idx)
+            fprintf(out, "%s %s %.1f\n", boards[i].name, boards[i].result, boards[i].latency_ms);
+    }
+    fprintf(out, "END\n");
+}
+
+/**
+ * 关闭客户端，等待中的请求直接丢弃；执行中的请求继续执行到结束以释放开发板，
+ * 在此之前该客户端槽位不会分配给新连接
+ */
+static void client_close(int idx) {
+    close(clients[idx].fd);
+    clients[idx].fd = -1;
+    clients[idx].len = 0;
+    clients[idx].eof = 0;
+    clients[idx].discard = 0;
+    if (jobs[idx].state == JOB_WAITING)
+        jobs[idx].state = JOB_IDLE;
+}
+
+/**
+ * 将已完成请求的结果发给发起请求的客户端并释放开发板，返回完成的请求数
+ */
+static int jobs_complete() {
+    int completed = 0;
+
+    for (int idx = 0; idx < MAX_CLIENTS; idx++) {
+        struct job *j = &jobs[idx];
+        if (j->state != JOB_RUNNING || j->pending > 0)
+            continue;
+
+        if (clients[idx].fd >= 0) {
+            char *out = NULL;
+            size_t out_len = 0;
+            FILE *fp = open_memstream(&out, &out_len);
+            if (fp) {
+                job_format(j, fp);
+                fclose(fp);
+                if (send(clients[idx].fd, out, out_len, MSG_NOSIGNAL) != (ssize_t)out_len)
+                    client_close(idx);
+                free(out);
+            }
+        }
+        for (int i = 0; i < board_count; i++) {
+            if (boards[i].owner == idx)
+                boards[i].owner = -1;
+        }
+        j->state = JOB_IDLE;
+        completed++;
+    }
+    return completed;
+}
+
+/**
+ * 从空闲客户端的缓冲区中取出下一条完整请求，再按到达顺序启动目标开发板空闲的请求；
+ * 暂时不能启动的请求预留其目标开发板，避免被后来的请求一直抢占。
+ * 已半关闭且请求全部处理完的客户端在这里关闭
+ * 返回取出和启动的请求数
+ */
+static int clients_dispatch() {
+    int progress = 0;
+
+    for (int idx = 0; idx < MAX_CLIENTS; idx++) {
+        struct client *c = &clients[idx];
+        char *nl;
+        while (c->fd >= 0 && jobs[idx].state == JOB_IDLE &&
+               (nl = memchr(c->buf, '\n', c->len)) != NULL) {
+            *nl = '\0';
+            if (nl > c->buf && nl[-1] == '\r')
+                nl[-1] = '\0';
+            char request[BUFFER_SIZE];
+            strcpy(request, c->buf);
+            size_t rest = c->len - (nl + 1 - c->buf);
+            memmove(c->buf, nl + 1, rest);
+            c->len = rest;
+
+            if (request[0] == '\0')
+                continue;
+            progress++;
+            int total = job_parse(&jobs[idx], idx, request);
+            if (total <= 0) {
+                const char *err = total == 0 ? "ERROR:NO_MATCHING_BOARD\nEND\n" : "ERROR:BAD_REQUEST\nEND\n";
+                send(c->fd, err, strlen(err), MSG_NOSIGNAL);
+            }
+        }
+        if (c->fd >= 0 && c->eof && jobs[idx].state == JOB_IDLE)
+            client_close(idx);
+    }
+
+    char reserved[MAX_BOARDS] = { 0 };
+    unsigned long last = 0;
+    for (;;) {
+        struct job *next = NULL;
+        for (int idx = 0; idx < MAX_CLIENTS; idx++) {
+            struct job *j = &jobs[idx];
+            if (j->state == JOB_WAITING && j->seq > last && (!next || j->seq < next->seq))
+                next = j;
+        }
+        if (!next)
+            break;
+        last = next->seq;
+
+        if (job_ready(next, reserved)) {
+            job_start(next);
+            progress++;
+            continue;
+        }
+        for (int i = 0; i < board_count; i++) {
+            if (board_matches(&boards[i], next->target))
+                reserved[i] = 1;
+        }
+    }
+    return progress;
+}
+
+/**
+ * 读取客户端数据，返回0表示保持连接，-1表示需要关闭连接
+ * 只在该客户端没有请求执行时调用，缓冲区中没有完整的请求行
+ */
+static int client_read(struct client *c) {
+    ssize_t n = recv(c->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len, 0);
+    if (n < 0)
+        return (errno == EINTR || errno == EAGAIN) ? 0 : -1;
+    if (n == 0) {
+        /* 半关闭：最后一行没有换行时也作为请求处理 */
+        c->eof = 1;
+        if (c->len > 0 && !c->discard)
+            c->buf[c->len++] = '\n';
+        return 0;
+    }
+    c->len += n;
+
+    if (c->discard) {
+        char *nl = memchr(c->buf, '\n', c->len);
+        if (!nl) {
+            c->len = 0;
+            return 0;
+        }
+        c->len -= nl + 1 - c->buf;
+        memmove(c->buf, nl + 1, c->len);
+        c->discard = 0;
+    }
+
+    /* 缓冲区已满仍没有完整的一行，拒绝该行并丢弃到下一个换行，连接保持 */
+    if (c->len >= sizeof(c->buf) - 1 && !memchr(c->buf, '\n', c->len)) {
+        const char *err = "ERROR:LINE_TOO_LONG\nEND\n";
+        if (send(c->fd, err, strlen(err), MSG_NOSIGNAL) < 0)
+            return -1;
+        c->len = 0;
+        c->discard = 1;
+    }
+    return 0;
+}
+
+/**
+ * 按间隔重新解析未解析的开发板。解析会阻塞，只在没有请求执行时进行，
+ * 不会拖慢其他开发板上正在执行的请求
+ */
+static void boards_resolve() {
+    struct timespec now;
+
+    for (int idx = 0; idx < MAX_CLIENTS; idx++) {
+        if (jobs[idx].state == JOB_RUNNING)
+            return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for (int i = 0; i < board_count; i++) {
+        struct board *b = &boards[i];
+        if (gpio_client_resolved(b->client) || elapsed_ms(&b->resolve_ts, &now) < RESOLVE_RETRY_MS)
+            continue;
+        if (gpio_client_resolve(b->client) == 0)
+            fprintf(stderr, "%s: 已解析 %s:%s\n", b->name, b->host, b->port);
+        clock_gettime(CLOCK_MONOTONIC, &b->resolve_ts);
+        return;                         // 每次最多解析一块板，避免连续阻塞
+    }
+}
+
+/**
+ * 事件循环，listen_fd为-1时为单次执行模式，当前请求完成后返回
+ */
+static void event_loop(int listen_fd) {
+    struct pollfd fds[1 + MAX_BOARDS + MAX_CLIENTS];
+    int owner[1 + MAX_BOARDS + MAX_CLIENTS];
+
+    while (running) {
+        if (listen_fd < 0) {
+            if (jobs[0].pending == 0)
+                return;
+        } else {
+            /* 命令全部立即失败的请求启动后就已完成，继续处理直到没有新进展 */
+            while (jobs_complete() + clients_dispatch() > 0)
+                ;
+            boards_resolve();
+        }
+
+        int nfds = 0;
+        if (listen_fd >= 0) {
+            fds[nfds].fd = listen_fd;
+            fds[nfds].events = POLLIN;
+            owner[nfds++] = -1;
+        }
+        /* 每块板的超时由客户端库管理，取最近的截止时间 */
+        int wait = IDLE_POLL_MS;
+        int board_start = nfds;
+        for (int i = 0; i < board_count; i++) {
+            int n = gpio_client_pollfds(boards[i].client, fds + nfds, GPIO_CLIENT_MAX_POOL);
+            for (int k = 0; k < n; k++)
+                owner[nfds++] = i;
+            int left = gpio_client_next_timeout(boards[i].client);
+            if (left >= 0 && left < wait)
+                wait = left;
+        }
+        /* 有请求未完成或已半关闭的客户端不读取，只检测连接错误 */
+        int client_start = nfds;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (listen_fd < 0 || clients[i].fd < 0)
+                continue;
+            fds[nfds].fd = clients[i].fd;
+            fds[nfds].events = (!clients[i].eof && jobs[i].state == JOB_IDLE) ? POLLIN : 0;
+            owner[nfds++] = i;
+        }
+
+        int ready = poll(fds, nfds, wait);
+        if (ready < 0) {
+            if (errno != EINTR)
+                perror("poll");
+            continue;
+        }
+
+        /* 每块板的连接池大小为1，最多占用一个pollfd；没有连接的板也要处理以检查超时 */
+        for (int i = 0, k = board_start; i < board_count; i++) {
+            int n = (k < client_start && owner[k] == i) ? 1 : 0;
+            gpio_client_process(boards[i].client, fds + k, n);
+            k += n;
+        }
+
+        for (int k = client_start; k < nfds; k++) {
+            if (!fds[k].revents)
+                continue;
+            struct client *c = &clients[owner[k]];
+            if (fds[k].revents & POLLIN) {
+                if (client_read(c) < 0)
+                    client_close(owner[k]);
+            } else if (fds[k].revents & (POLLERR | POLLHUP)) {
+                client_close(owner[k]);
+            }
+        }
+
+        if (listen_fd >= 0 && (fds[0].revents & POLLIN)) {
+            int fd;
+            while ((fd = accept(listen_fd, NULL, NULL)) >= 0) {
+                int slot = -1;
+                for (int i = 0; i < MAX_CLIENTS; i++) {
+                    if (clients[i].fd < 0 && jobs[i].state == JOB_IDLE) {
+                        slot = i;
+                        break;
+                    }
+                }
+                if (slot < 0) {
+                    close(fd);
+                    continue;
+                }
+                clients[slot].fd = fd;
+                clients[slot].len = 0;
+                clients[slot].eof = 0;
+                clients[slot].discard = 0;
+            }
+        }
+    }
+}
+
+/**
+ * 创建网关监听套接字
+ */
+static int open_listener(const char *port) {
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(atoi(port));
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    const char *board_file = NULL;
+    const char *request = NULL;
+    const char *listen_port = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:t:c:l:")) != -1) {
+        switch (opt) {
+            case 'b': board_file = optarg; break;
+            case 't': timeout_ms = atoi(optarg); break;
+            case 'c': request = optarg; break;
+            case 'l': listen_port = optarg; break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (!board_file || (!request && !listen_port) || timeout_ms <= 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (load_boards(board_file) < 0)
+        return EXIT_FAILURE;
+
+    for (int i = 0; i < MAX_CLIENTS; i++)
+        clients[i].fd = -1;
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    signal(SIGPIPE, SIG_IGN);
+
+    /* 单次执行模式 */
+    if (request) {
+        int total = job_parse(&jobs[0], -1, request);
+        if (total < 0) {
+            fprintf(stderr, "请求格式错误，应为: 目标 命令\n");
+            return EXIT_FAILURE;
+        }
+        if (total == 0) {
+            fprintf(stderr, "没有匹配 %s 的开发板\n", jobs[0].target);
+            return EXIT_FAILURE;
+        }
+        job_start(&jobs[0]);
+        event_loop(-1);
+        job_format(&jobs[0], stdout);
+
+        int failed = 0;
+        for (int i = 0; i < board_count; i++) {
+            if (boards[i].owner == 0 && strncmp(boards[i].result, "ERROR", 5) == 0)
+                failed++;
+            gpio_client_free(boards[i].client);
+        }
+        return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    /* 网关服务模式 */
+    int listen_fd = open_listener(listen_port);
+    if (listen_fd < 0)
+        return EXIT_FAILURE;
+    fprintf(stderr, "网关已启动，监听端口 %s，开发板 %d 块\n", listen_port, board_count);
+
+    event_loop(listen_fd);
+
+    for (int i = 0; i < board_count; i++)
+        gpio_client_free(boards[i].client);
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0)
+            client_close(i);
+    }
+    close(listen_fd);
+    return EXIT_SUCCESS;
+}
@@ -1,5 +1,6 @@
 #!/bin/bash
 # GPIO守护进程编译和安装脚本
+# 环境变量 SKIP_APT=1 时不安装依赖（软件包已由 initial_board.sh 统一安装），缺少依赖时直接报错
 
 # 定义颜色
 GREEN='\033[0;32m'
@@ -20,11 +21,14 @@ echo -e "${YELLOW}开始编译和安装GPIO守护进程...${NC}"
 # 检查libgpiod开发库是否已安装
 if pkg-config --exists libgpiod 2>/dev/null; then
     echo -e "${GREEN}libgpiod开发库已安装，跳过安装步骤${NC}"
+elif [ "${SKIP_APT:-0}" = "1" ]; then
+    echo -e "${RED}错误: 未找到libgpiod开发库（需要 libgpiod-dev 和 pkg-config），SKIP_APT=1，不自动安装${NC}"
+    exit 1
 else
     # 安装依赖
     echo -e "${YELLOW}安装libgpiod依赖...${NC}"
     apt-get update
-    apt-get install -y libgpiod-dev
+    apt-get install -y libgpiod-dev pkg-config
     
     # 再次检查是否安装成功
     if ! pkg-config --exists libgpiod 2>/dev/null; then
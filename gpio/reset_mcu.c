@@ -0,0 +1,64 @@
+/**
+ * reset_mcu.c - 仅用于复位MCU的简易工具（替代 reset_mcu.sh，不再依赖 nc）
+ *
+ * 编译：make reset_mcu
+ * 运行：./reset_mcu [-H host] [-p port] [-t timeout_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gpio_client.h"
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "用法: %s [-H host] [-p port] [-t timeout_ms]\n"
+            "  -H host   服务器地址，默认: localhost\n"
+            "  -p port   服务器端口，默认: 8888\n"
+            "  -t ms     等待响应的超时时间，默认: %d\n",
+            prog, GPIO_CLIENT_DEFAULT_TIMEOUT_MS);
+}
+
+int main(int argc, char **argv) {
+    const char *host = "localhost";
+    const char *port = "8888";
+    int timeout_ms = GPIO_CLIENT_DEFAULT_TIMEOUT_MS;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "H:p:t:h")) != -1) {
+        switch (opt) {
+            case 'H': host = optarg; break;
+            case 'p': port = optarg; break;
+            case 't': timeout_ms = atoi(optarg); break;
+            case 'h': print_usage(argv[0]); return EXIT_SUCCESS;
+            default:
+                print_usage(argv[0]);
+                return 2;
+        }
+    }
+
+    gpio_client *client = gpio_client_new(host, port, 1);
+    if (!client) {
+        fprintf(stderr, "无法创建客户端 %s:%s\n", host, port);
+        return EXIT_FAILURE;
+    }
+    gpio_client_set_timeout(client, timeout_ms);
+
+    char resp[GPIO_CLIENT_RESPONSE_SIZE] = "";
+    int ret = gpio_client_call(client, "reset", resp, sizeof(resp));
+    gpio_client_free(client);
+
+    if (ret != GPIO_CLIENT_OK) {
+        fprintf(stderr, "复位命令发送失败: %s\n", gpio_client_strerror(ret));
+        return EXIT_FAILURE;
+    }
+
+    printf("%s\n", resp);
+    if (strncmp(resp, "OK:RESET", 8) != 0) {
+        fprintf(stderr, "警告: 复位命令未被确认，请检查gpio-daemon服务与连接\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -2,65 +2,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <errno.h>
-#include <sys/types.h>
-#include <sys/socket.h>
-#include <netdb.h>
 
-#define BUFFER_SIZE 1024
-
-static int send_command(const char *host, const char *port, const char *cmd, char *response, size_t response_len) {
-    struct addrinfo hints;
-    struct addrinfo *result = NULL, *rp = NULL;
-    int sockfd = -1;
-    int ret = -1;
+#include "gpio_client.h"
 
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_UNSPEC;      // 支持IPv4/IPv6
-    hints.ai_socktype = SOCK_STREAM;  // TCP
+#define BUFFER_SIZE 1024
 
-    int s = getaddrinfo(host, port, &hints, &result);
-    if (s != 0) {
-        fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(s));
+static int send_command(gpio_client *client, const char *cmd, char *response, size_t response_len) {
+    int ret = gpio_client_call(client, cmd, response, response_len);
+    if (ret != GPIO_CLIENT_OK) {
+        fprintf(stderr, "命令 %s 失败: %s\n", cmd, gpio_client_strerror(ret));
         return -1;
     }
-
-    for (rp = result; rp != NULL; rp = rp->ai_next) {
-        sockfd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
-        if (sockfd == -1) continue;
-        if (connect(sockfd, rp->ai_addr, rp->ai_addrlen) == 0) break; // 成功
-        close(sockfd);
-        sockfd = -1;
-    }
-
-    if (rp == NULL) {
-        fprintf(stderr, "无法连接到 %s:%s\n", host, port);
-        goto cleanup;
-    }
-
-    // 发送命令（不带换行）
-    size_t cmd_len = strlen(cmd);
-    if (send(sockfd, cmd, cmd_len, 0) != (ssize_t)cmd_len) {
-        fprintf(stderr, "发送命令失败: %s\n", strerror(errno));
-        goto cleanup;
-    }
-
-    // 接收响应
-    if (response && response_len > 0) {
-        ssize_t n = recv(sockfd, response, response_len - 1, 0);
-        if (n < 0) {
-            fprintf(stderr, "接收响应失败: %s\n", strerror(errno));
-            goto cleanup;
-        }
-        response[n] = '\0';
-    }
-
-    ret = 0;
-
-cleanup:
-    if (sockfd != -1) close(sockfd);
-    if (result) freeaddrinfo(result);
-    return ret;
+    return 0;
 }
 
 static void print_usage(const char *prog) {
@@ -74,7 +27,7 @@ static void print_usage(const char *prog) {
             prog);
 }
 
-static void run_auto_test(const char *host, const char *port) {
+static void run_auto_test(gpio_client *client) {
     const char *sequence[] = {
         "status",
         "normal",
@@ -91,7 +44,7 @@ static void run_auto_test(const char *host, const char *port) {
     printf("开始自动测试...\n");
     for (size_t i = 0; i < sizeof(sequence)/sizeof(sequence[0]); ++i) {
         const char *cmd = sequence[i];
-        if (send_command(host, port, cmd, resp, sizeof(resp)) == 0) {
+        if (send_command(client, cmd, resp, sizeof(resp)) == 0) {
             printf("命令: %-10s => 响应: %s\n", cmd, resp);
         } else {
             printf("命令: %-10s => 发送失败\n", cmd);
@@ -101,7 +54,7 @@ static void run_auto_test(const char *host, const char *port) {
     printf("自动测试完成。\n");
 }
 
-static void run_interactive(const char *host, const char *port) {
+static void run_interactive(gpio_client *client) {
     char line[BUFFER_SIZE];
     char resp[BUFFER_SIZE];
 
@@ -118,7 +71,7 @@ static void run_interactive(const char *host, const char *port) {
         if (len == 0) continue;
         if (strcmp(line, "exit") == 0 || strcmp(line, "quit") == 0) break;
 
-        if (send_command(host, port, line, resp, sizeof(resp)) == 0) {
+        if (send_command(client, line, resp, sizeof(resp)) == 0) {
             printf("响应: %s\n", resp);
         } else {
             printf("发送失败\n");
@@ -145,21 +98,27 @@ int main(int argc, char **argv) {
         }
     }
 
-    if (auto_mode) {
-        run_auto_test(host, port);
-        return EXIT_SUCCESS;
+    /* 地址只解析一次，整个会话复用同一连接 */
+    gpio_client *client = gpio_client_new(host, port, 1);
+    if (!client) {
+        fprintf(stderr, "无法创建客户端 %s:%s\n", host, port);
+        return EXIT_FAILURE;
     }
 
-    if (command) {
+    int ret = EXIT_SUCCESS;
+    if (auto_mode) {
+        run_auto_test(client);
+    } else if (command) {
         char resp[BUFFER_SIZE];
-        if (send_command(host, port, command, resp, sizeof(resp)) == 0) {
+        if (send_command(client, command, resp, sizeof(resp)) == 0) {
             printf("%s\n", resp);
-            return EXIT_SUCCESS;
         } else {
-            return EXIT_FAILURE;
+            ret = EXIT_FAILURE;
         }
+    } else {
+        run_interactive(client);
     }
 
-    run_interactive(host, port);
-    return EXIT_SUCCESS;
+    gpio_client_free(client);
+    return ret;
 } 
\ No newline at end of file
@@ -0,0 +1,374 @@
+/**
+ * test_gpio_client_lib.c - gpio_client 库回归测试
+ *
+ * 用本地假服务器模拟守护进程，不需要真实开发板：
+ * 1. 一次收到多条响应，第一个回调里再次提交请求，而此时连接已被对端重置，
+ *    提交时发送失败使连接在回调中被关闭；其余已收到的响应仍应成功返回，
+ *    且不能把旧数据交给重连后的新请求
+ * 2. 地址解析失败时 gpio_client_submit 立即返回 GPIO_CLIENT_ERR_RESOLVE，
+ *    只有 gpio_client_resolve 会重新解析
+ * 3. 一条响应被拆成多段到达，应拼接成完整的一行
+ * 4. 同一连接上流水线发出的多条请求，响应在一个数据段内到达，按先进先出对应到各自请求
+ * 5. 请求超时后返回 GPIO_CLIENT_ERR_TIMEOUT 并断开连接，之后的请求使用新连接
+ *
+ * 编译运行：make check
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "gpio_client.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static int listen_fd = -1;
+static volatile int reset_sent = 0;
+
+/* 在回环地址的随机端口上监听，启动假服务器线程，端口号写入port */
+static void start_server(void *(*fn)(void *), pthread_t *thread, char *port, size_t port_len) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+    listen(listen_fd, 4);
+    getsockname(listen_fd, (struct sockaddr *)&addr, &len);
+    snprintf(port, port_len, "%d", ntohs(addr.sin_port));
+    pthread_create(thread, NULL, fn, NULL);
+}
+
+static void stop_server(pthread_t thread) {
+    pthread_join(thread, NULL);
+    close(listen_fd);
+    listen_fd = -1;
+}
+
+/* 读取一行请求（不含换行），对端关闭返回-1 */
+static int read_line(int fd, char *line, size_t size) {
+    size_t len = 0;
+    char c;
+    while (read(fd, &c, 1) == 1) {
+        if (c == '\n') {
+            line[len] = '\0';
+            return 0;
+        }
+        if (len + 1 < size)
+            line[len++] = c;
+    }
+    return -1;
+}
+
+/* 读取count行请求 */
+static void read_lines(int fd, int count) {
+    char c;
+    while (count > 0 && read(fd, &c, 1) == 1) {
+        if (c == '\n')
+            count--;
+    }
+}
+
+/**
+ * 假服务器：第一个连接收到3条请求后一次性返回3条响应，再用RST关闭；
+ * 第二个连接对每条请求回复 fresh
+ */
+static void *server_thread(void *arg) {
+    int fd = accept(listen_fd, NULL, NULL);
+    read_lines(fd, 3);
+    const char *replies = "one\ntwo\nthree\n";
+    if (write(fd, replies, strlen(replies)) < 0)
+        perror("write");
+    struct linger lg = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    close(fd);
+    reset_sent = 1;
+
+    fd = accept(listen_fd, NULL, NULL);
+    read_lines(fd, 1);
+    if (write(fd, "fresh\n", 6) < 0)
+        perror("write");
+    read_lines(fd, 1);
+    close(fd);
+    return NULL;
+}
+
+struct result {
+    int status;
+    char response[64];
+    int calls;
+};
+
+static gpio_client *client;
+static struct result results[5];
+
+static void on_reply(void *arg, int status, const char *response) {
+    struct result *r = arg;
+    r->calls++;
+    r->status = status;
+    if (status == GPIO_CLIENT_OK)
+        snprintf(r->response, sizeof(r->response), "%s", response);
+
+    /* 第一个响应的回调里继续提交，连接已被重置，发送会失败 */
+    if (r == &results[0])
+        gpio_client_submit(client, "status", on_reply, &results[3]);
+    /* 该请求失败后再提交一次，应建立新连接并只收到新连接上的响应 */
+    else if (r == &results[3])
+        gpio_client_submit(client, "status", on_reply, &results[4]);
+}
+
+static void test_reentrant_callbacks(void) {
+    char port[16];
+    pthread_t server;
+
+    start_server(server_thread, &server, port, sizeof(port));
+
+    client = gpio_client_new("127.0.0.1", port, 1);
+    CHECK(client != NULL);
+    gpio_client_set_timeout(client, 2000);
+    memset(results, 0, sizeof(results));
+    for (int i = 0; i < 3; i++)
+        CHECK(gpio_client_submit(client, "status", on_reply, &results[i]) == GPIO_CLIENT_OK);
+
+    /* 只处理可写事件把请求发出去，等响应和RST都到达后再读，保证回调中的提交一定遇到已重置的连接 */
+    while (!reset_sent) {
+        struct pollfd fds[GPIO_CLIENT_MAX_POOL];
+        int n = gpio_client_pollfds(client, fds, GPIO_CLIENT_MAX_POOL);
+        for (int i = 0; i < n; i++)
+            fds[i].events &= ~POLLIN;
+        poll(fds, n, 10);
+        for (int i = 0; i < n; i++)
+            fds[i].revents &= POLLOUT;
+        gpio_client_process(client, fds, n);
+    }
+    usleep(50 * 1000);
+    while (gpio_client_pending(client) > 0) {
+        struct pollfd fds[GPIO_CLIENT_MAX_POOL];
+        int n = gpio_client_pollfds(client, fds, GPIO_CLIENT_MAX_POOL);
+        poll(fds, n, gpio_client_next_timeout(client));
+        gpio_client_process(client, fds, n);
+    }
+
+    const char *expected[] = { "one", "two", "three" };
+    for (int i = 0; i < 3; i++) {
+        CHECK(results[i].calls == 1);
+        CHECK(results[i].status == GPIO_CLIENT_OK);
+        CHECK(strcmp(results[i].response, expected[i]) == 0);
+    }
+    CHECK(results[3].calls == 1);
+    CHECK(results[3].status == GPIO_CLIENT_ERR_IO);
+    CHECK(results[4].calls == 1);
+    CHECK(results[4].status == GPIO_CLIENT_OK);
+    CHECK(strcmp(results[4].response, "fresh") == 0);
+
+    gpio_client_free(client);
+    stop_server(server);
+}
+
+static void test_resolve_error(void) {
+    gpio_client *c = gpio_client_new("no-such-host.invalid", "8888", 1);
+    CHECK(c != NULL);
+    if (!c)
+        return;
+    CHECK(!gpio_client_resolved(c));
+    CHECK(gpio_client_submit(c, "status", on_reply, &results[0]) == GPIO_CLIENT_ERR_RESOLVE);
+    CHECK(gpio_client_pending(c) == 0);
+    CHECK(gpio_client_resolve(c) == GPIO_CLIENT_ERR_RESOLVE);
+    CHECK(!gpio_client_resolved(c));
+    gpio_client_free(c);
+}
+
+/* 不做额外操作的回调 */
+static void on_result(void *arg, int status, const char *response) {
+    struct result *r = arg;
+    r->calls++;
+    r->status = status;
+    if (status == GPIO_CLIENT_OK)
+        snprintf(r->response, sizeof(r->response), "%s", response);
+}
+
+/* 处理事件直到没有未完成的请求 */
+static void run_until_idle(gpio_client *c) {
+    while (gpio_client_pending(c) > 0) {
+        struct pollfd fds[GPIO_CLIENT_MAX_POOL];
+        int n = gpio_client_pollfds(c, fds, GPIO_CLIENT_MAX_POOL);
+        poll(fds, n, gpio_client_next_timeout(c));
+        gpio_client_process(c, fds, n);
+    }
+}
+
+/* 假服务器：把一条响应分三段发送，每段之间停顿，保证客户端分多次读到 */
+static void *split_server_thread(void *arg) {
+    char line[64];
+    int fd = accept(listen_fd, NULL, NULL);
+    read_line(fd, line, sizeof(line));
+    const char *parts[] = { "STATUS:", "NOR", "MAL\n" };
+    for (int i = 0; i < 3; i++) {
+        if (write(fd, parts[i], strlen(parts[i])) < 0)
+            perror("write");
+        usleep(50 * 1000);
+    }
+    while (read_line(fd, line, sizeof(line)) == 0)
+        ;
+    close(fd);
+    return NULL;
+}
+
+static void test_split_reply(void) {
+    char port[16];
+    pthread_t server;
+
+    start_server(split_server_thread, &server, port, sizeof(port));
+    gpio_client *c = gpio_client_new("127.0.0.1", port, 1);
+    CHECK(c != NULL);
+    memset(results, 0, sizeof(results));
+    CHECK(gpio_client_submit(c, "status", on_result, &results[0]) == GPIO_CLIENT_OK);
+    run_until_idle(c);
+
+    CHECK(results[0].calls == 1);
+    CHECK(results[0].status == GPIO_CLIENT_OK);
+    CHECK(strcmp(results[0].response, "STATUS:NORMAL") == 0);
+
+    gpio_client_free(c);
+    stop_server(server);
+}
+
+#define PIPELINE_COUNT 5
+
+/* 假服务器：收齐全部请求后，把每条请求的响应合在一次写入中返回 */
+static void *pipeline_server_thread(void *arg) {
+    char line[64];
+    char replies[512];
+    size_t len = 0;
+    int fd = accept(listen_fd, NULL, NULL);
+    for (int i = 0; i < PIPELINE_COUNT; i++) {
+        if (read_line(fd, line, sizeof(line)) < 0)
+            break;
+        len += snprintf(replies + len, sizeof(replies) - len, "OK:%s\n", line);
+    }
+    if (write(fd, replies, len) < 0)
+        perror("write");
+    while (read_line(fd, line, sizeof(line)) == 0)
+        ;
+    close(fd);
+    return NULL;
+}
+
+static void test_pipelined_fifo(void) {
+    char port[16];
+    char cmd[16];
+    char expected[32];
+    pthread_t server;
+
+    start_server(pipeline_server_thread, &server, port, sizeof(port));
+    /* 连接池大小为1，所有请求都在同一连接上排队 */
+    gpio_client *c = gpio_client_new("127.0.0.1", port, 1);
+    CHECK(c != NULL);
+    memset(results, 0, sizeof(results));
+    for (int i = 0; i < PIPELINE_COUNT; i++) {
+        snprintf(cmd, sizeof(cmd), "cmd%d", i);
+        CHECK(gpio_client_submit(c, cmd, on_result, &results[i]) == GPIO_CLIENT_OK);
+    }
+    CHECK(gpio_client_pending(c) == PIPELINE_COUNT);
+    run_until_idle(c);
+
+    for (int i = 0; i < PIPELINE_COUNT; i++) {
+        snprintf(expected, sizeof(expected), "OK:cmd%d", i);
+        CHECK(results[i].calls == 1);
+        CHECK(results[i].status == GPIO_CLIENT_OK);
+        CHECK(strcmp(results[i].response, expected) == 0);
+    }
+
+    gpio_client_free(c);
+    stop_server(server);
+}
+
+static volatile int timeout_conn_closed = 0;
+
+/* 假服务器：第一个连接只读请求不回复，直到客户端断开；第二个连接正常回复 */
+static void *timeout_server_thread(void *arg) {
+    char line[64];
+    int fd = accept(listen_fd, NULL, NULL);
+    while (read_line(fd, line, sizeof(line)) == 0)
+        ;
+    close(fd);
+    timeout_conn_closed = 1;
+
+    fd = accept(listen_fd, NULL, NULL);
+    read_line(fd, line, sizeof(line));
+    if (write(fd, "fresh\n", 6) < 0)
+        perror("write");
+    while (read_line(fd, line, sizeof(line)) == 0)
+        ;
+    close(fd);
+    return NULL;
+}
+
+static void test_timeout_drops_connection(void) {
+    char port[16];
+    pthread_t server;
+    struct timespec start, end;
+
+    start_server(timeout_server_thread, &server, port, sizeof(port));
+    gpio_client *c = gpio_client_new("127.0.0.1", port, 1);
+    CHECK(c != NULL);
+    gpio_client_set_timeout(c, 200);
+    memset(results, 0, sizeof(results));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CHECK(gpio_client_submit(c, "status", on_result, &results[0]) == GPIO_CLIENT_OK);
+    CHECK(gpio_client_submit(c, "status", on_result, &results[1]) == GPIO_CLIENT_OK);
+    run_until_idle(c);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    long elapsed = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000;
+    CHECK(elapsed >= 190 && elapsed < 2000);
+    for (int i = 0; i < 2; i++) {
+        CHECK(results[i].calls == 1);
+        CHECK(results[i].status == GPIO_CLIENT_ERR_TIMEOUT);
+    }
+
+    /* 超时的连接应已被客户端关闭，服务器读到EOF */
+    for (int i = 0; i < 100 && !timeout_conn_closed; i++)
+        usleep(10 * 1000);
+    CHECK(timeout_conn_closed);
+
+    CHECK(gpio_client_submit(c, "status", on_result, &results[2]) == GPIO_CLIENT_OK);
+    run_until_idle(c);
+    CHECK(results[2].calls == 1);
+    CHECK(results[2].status == GPIO_CLIENT_OK);
+    CHECK(strcmp(results[2].response, "fresh") == 0);
+
+    gpio_client_free(c);
+    stop_server(server);
+}
+
+int main(void) {
+    test_reentrant_callbacks();
+    test_resolve_error();
+    test_split_reply();
+    test_pipelined_fifo();
+    test_timeout_drops_connection();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d 项检查失败\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("全部通过\n");
+    return EXIT_SUCCESS;
+}
@@ -5,14 +5,51 @@ set -e  # 任何命令失败时立即退出
 # 设备驱动安装与开发工具配置脚本 (Ubuntu 22.04)
 # 优化点：
 # 1. 合并APT操作为单命令  2. 增加错误检查  3. 自动权限验证
+# 4. 按依赖关系并行执行各步骤，并统计每步耗时
+# 5. 已完成的步骤自动跳过，重复执行只需数秒
+# 6. 离线模式：从本地软件包目录安装，不依赖网络镜像
 # =================================================================
 
+# --------------------- 使用说明 ---------------------
+show_usage() {
+    echo "用法:"
+    echo "  sudo $0 [选项] [ch341.ko路径] [dfu-util.deb路径]"
+    echo "  sudo $0 --build-bundle 目录     在联网的开发板上制作离线软件包目录"
+    echo ""
+    echo "选项:"
+    echo "  --offline 目录   从离线软件包目录安装，不访问网络镜像，不执行系统升级"
+    echo "  -j 并发数        同时执行的步骤数 (默认: 4，1 表示逐步执行)"
+    echo "  --force         忽略已完成检查，重新执行所有步骤"
+}
+
 # --------------------- 权限验证 ---------------------
 if [ "$(id -u)" != "0" ]; then
     echo "错误：本脚本必须使用sudo或root权限运行"
     exit 1
 fi
 
+# --------------------- 选项解析 ---------------------
+OFFLINE_DIR=""
+BUNDLE_OUT=""
+MAX_JOBS=4
+FORCE_ALL=false
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --offline)      OFFLINE_DIR="$(readlink -f "$2")"; shift 2 ;;
+        --build-bundle) BUNDLE_OUT="$2"; shift 2 ;;
+        -j)             MAX_JOBS="$2"; shift 2 ;;
+        --force)        FORCE_ALL=true; shift ;;
+        -h|--help)      show_usage; exit 0 ;;
+        *)              break ;;
+    esac
+done
+
+if ! [[ "$MAX_JOBS" =~ ^[1-9][0-9]*$ ]]; then
+    echo "错误: 无效的并发数 $MAX_JOBS"
+    exit 1
+fi
+
 # --------------------- 参数检查 ---------------------
 KO_FILE="${1:-$(dirname "$0")/ch341.ko}"  # 默认路径参数
 INSTALL_SCRIPT="$(dirname "$0")/install_ch341.sh"
@@ -27,28 +64,68 @@ USB_ACM_RULES_FILE="${RULES_DIR}/70-usbACM.rules"  # USB ACM设备规则文件
 GPIO_DIR="$(dirname "$0")/gpio"  # GPIO相关文件目录
 GPIO_SCRIPT="${GPIO_DIR}/initial_gpio.sh"  # GPIO初始化脚本
 GPIO_SERVICE="${GPIO_DIR}/gpio-init.service"  # GPIO初始化服务文件
+GPIO_DAEMON_SOURCE="${GPIO_DIR}/gpio_daemon.c"  # GPIO守护进程源代码
+GPIO_DAEMON_SERVICE="${GPIO_DIR}/gpio-daemon.service"  # GPIO守护进程服务文件
+GPIO_DAEMON_INSTALL_SCRIPT="${GPIO_DIR}/install_gpio.sh"  # GPIO守护进程安装脚本
+
+STATE_DIR="/var/lib/board-provision"  # 各步骤的完成记录
+DPKG_LOCK="${STATE_DIR}/dpkg.lock"    # 并行执行时串行化apt/dpkg操作
+OFFLINE_LIST="${STATE_DIR}/offline.list"
+
+# 所需软件包，离线包目录也按此列表制作
+REQUIRED_PACKAGES=(
+    cpio gzip findutils busybox              # NVIDIA驱动更新所需的基础工具
+    picocom sshpass stlink-tools byobu       # 开发工具
+    python3.10-venv iwlwifi-modules          # Python环境和WiFi驱动
+    libgpiod-dev pkg-config                  # GPIO守护进程编译依赖（install_gpio.sh 用pkg-config检查）
+)
+# install_ch341.sh 原先安装的编译环境，仅尽力安装，失败不影响后续步骤
+OPTIONAL_PACKAGES=(unzip build-essential "linux-headers-$(uname -r)")
+
+# 离线模式优先使用离线目录中的dfu-util包
+if [ -n "$OFFLINE_DIR" ] && [ -z "${2:-}" ]; then
+    BUNDLED_DFU=$(find "$OFFLINE_DIR" -maxdepth 1 -name 'dfu-util_*.deb' | head -1)
+    [ -n "$BUNDLED_DFU" ] && DFU_DEB_FILE="$BUNDLED_DFU"
+fi
 
-echo "======= 开始设备驱动安装 ======="
+# --------------------- 制作离线软件包目录 ---------------------
+build_bundle() {
+    local out="$1"
+    mkdir -p "$out"
+    out="$(readlink -f "$out")"
 
-# --------------------- 替换软件源 ---------------------
-echo "步骤0: 替换软件源为清华大学镜像"
-if [ -f "$SOURCES_LIST_FILE" ]; then
-    # 备份原有软件源（仅在备份文件不存在时）
-    if [ -f "/etc/apt/sources.list" ]; then
-        if [ -f "/etc/apt/sources.list.back" ]; then
-            echo "备份文件 /etc/apt/sources.list.back 已存在，跳过备份"
-        else
-            echo "备份原有软件源到 /etc/apt/sources.list.back"
-            cp /etc/apt/sources.list /etc/apt/sources.list.back
-        fi
+    echo "======= 制作离线软件包目录: $out ======="
+    apt-get update -qq
+
+    # 递归解析依赖，下载完整的依赖闭包，目标板离线安装时按需选用
+    local pkgs
+    pkgs=$(apt-cache depends --recurse --no-recommends --no-suggests \
+               --no-conflicts --no-breaks --no-replaces --no-enhances \
+               "${REQUIRED_PACKAGES[@]}" "${OPTIONAL_PACKAGES[@]}" 2>/dev/null \
+           | grep '^[a-zA-Z0-9]' | sort -u)
+    (cd "$out" && apt-get download $pkgs)
+
+    cp -v "$DFU_DEB_FILE" "$out/"
+
+    echo "生成软件包索引..."
+    if command -v apt-ftparchive >/dev/null 2>&1; then
+        (cd "$out" && apt-ftparchive packages . > Packages)
+    else
+        (cd "$out" && dpkg-scanpackages . /dev/null > Packages)
     fi
-    
-    # 复制新的软件源
-    echo "复制新的软件源文件"
-    cp "$SOURCES_LIST_FILE" /etc/apt/sources.list
-    echo "√ 软件源替换完成"
-else
-    echo "警告: 软件源文件 $SOURCES_LIST_FILE 不存在，跳过软件源替换"
+
+    echo "√ 离线软件包目录已生成，共 $(ls "$out"/*.deb | wc -l) 个软件包"
+    echo "使用: sudo $0 --offline $out"
+}
+
+if [ -n "$BUNDLE_OUT" ]; then
+    build_bundle "$BUNDLE_OUT"
+    exit 0
+fi
+
+if [ -n "$OFFLINE_DIR" ] && [ ! -f "$OFFLINE_DIR/Packages" ]; then
+    echo "错误: 离线软件包目录 $OFFLINE_DIR 中没有 Packages 索引，请先使用 --build-bundle 制作"
+    exit 16
 fi
 
 # 检查驱动安装脚本是否存在
@@ -104,88 +181,447 @@ if [ ! -f "$SOURCES_LIST_FILE" ]; then
     echo "警告: 软件源文件 $SOURCES_LIST_FILE 不存在，将使用系统默认软件源"
 fi
 
-# --------------------- 执行驱动安装 ---------------------
-echo "步骤1: 安装 CH341 驱动 ($KO_FILE)"
-chmod +x "$INSTALL_SCRIPT"  # 确保脚本可执行
-"$INSTALL_SCRIPT" "$KO_FILE"
-echo "√ CH341驱动安装完成"
+# 检查GPIO目录是否存在
+if [ ! -d "$GPIO_DIR" ]; then
+    echo "错误: GPIO目录 $GPIO_DIR 不存在!"
+    exit 10
+fi
 
-# --------------------- 安装dfu工具 ---------------------
-echo "步骤2: 安装DFU工具 ($DFU_DEB_FILE)"
-chmod +x "$DFU_INSTALL_SCRIPT"  # 确保脚本可执行
-"$DFU_INSTALL_SCRIPT" "$DFU_DEB_FILE"
-echo "√ DFU工具安装完成"
-
-# --------------------- 安装机器人串口规则 ---------------------
-echo "步骤2.1: 安装机器人串口规则"
-ROBOT_SERIAL_UDEV_RULE="/etc/udev/rules.d/99-robot-serial.rules"
-cp -v "$ROBOT_SERIAL_RULES_FILE" "$ROBOT_SERIAL_UDEV_RULE"
-echo "已安装机器人串口规则：$ROBOT_SERIAL_UDEV_RULE"
-
-# --------------------- 安装USB ACM设备规则 ---------------------
-echo "步骤2.2: 安装USB ACM设备规则"
-USB_ACM_UDEV_RULE="/etc/udev/rules.d/70-usbACM.rules"
-cp -v "$USB_ACM_RULES_FILE" "$USB_ACM_UDEV_RULE"
-echo "已安装USB ACM设备规则：$USB_ACM_UDEV_RULE"
-
-# 重载所有udev规则
-echo "重载udev规则..."
-udevadm control --reload-rules
-udevadm trigger
-echo "√ 所有udev规则安装完成"
-
-# --------------------- 安装基础工具 ---------------------
-echo "步骤3: 安装基础系统工具"
-apt update -qq
-
-echo "安装NVIDIA驱动更新所需的基础工具..."
-apt install -y cpio gzip findutils busybox || {
-    echo "警告: 基础工具安装失败，尝试修复..."
-    apt --fix-broken install -y
-    apt install -y cpio gzip findutils busybox
+# 检查GPIO初始化脚本是否存在
+if [ ! -f "$GPIO_SCRIPT" ]; then
+    echo "错误: GPIO初始化脚本 $GPIO_SCRIPT 不存在!"
+    exit 11
+fi
+
+# 检查GPIO服务文件是否存在
+if [ ! -f "$GPIO_SERVICE" ]; then
+    echo "错误: GPIO服务文件 $GPIO_SERVICE 不存在!"
+    exit 12
+fi
+
+# 检查GPIO守护进程安装脚本是否存在
+if [ ! -f "$GPIO_DAEMON_INSTALL_SCRIPT" ]; then
+    echo "错误: GPIO守护进程安装脚本 $GPIO_DAEMON_INSTALL_SCRIPT 不存在!"
+    exit 13
+fi
+
+# 检查GPIO守护进程源代码是否存在
+if [ ! -f "$GPIO_DAEMON_SOURCE" ]; then
+    echo "错误: GPIO守护进程源代码 $GPIO_DAEMON_SOURCE 不存在!"
+    exit 14
+fi
+
+# 检查GPIO守护进程服务文件是否存在
+if [ ! -f "$GPIO_DAEMON_SERVICE" ]; then
+    echo "错误: GPIO守护进程服务文件 $GPIO_DAEMON_SERVICE 不存在!"
+    exit 15
+fi
+
+mkdir -p "$STATE_DIR"
+
+# 离线模式的软件源列表，所有apt操作（包括install_dfu.sh的依赖修复）都只使用离线目录
+if [ -n "$OFFLINE_DIR" ]; then
+    echo "deb [trusted=yes] file:$OFFLINE_DIR ./" > "$OFFLINE_LIST"
+fi
+
+# --------------------- 辅助函数 ---------------------
+# 软件包是否已安装
+pkg_installed() {
+    dpkg-query -W -f='${Status}' "$1" 2>/dev/null | grep -q "install ok installed"
+}
+
+# 在dpkg锁内执行，避免并行步骤同时操作apt/dpkg
+with_dpkg_lock() {
+    ( flock 9; "$@" ) 9>"$DPKG_LOCK"
+}
+
+# 离线模式下只使用离线目录作为软件源
+apt_get() {
+    if [ -n "$OFFLINE_DIR" ]; then
+        apt-get -o Dir::Etc::SourceList="$OFFLINE_LIST" \
+                -o Dir::Etc::SourceParts="-" \
+                -o APT::Get::List-Cleanup="0" "$@"
+    else
+        apt-get "$@"
+    fi
+}
+
+# 一组文件的内容哈希，用于判断源文件是否变化
+files_hash() {
+    cat "$@" | sha256sum | awk '{print $1}'
+}
+
+# =================================================================
+# 各步骤：step_<名称> 执行安装，done_<名称> 判断是否已完成可跳过
+# =================================================================
+
+# --------------------- 替换软件源 ---------------------
+done_sources() {
+    [ ! -f "$SOURCES_LIST_FILE" ] || cmp -s "$SOURCES_LIST_FILE" /etc/apt/sources.list
+}
+
+step_sources() {
+    echo "替换软件源为清华大学镜像"
+    # 备份原有软件源（仅在备份文件不存在时）
+    if [ -f "/etc/apt/sources.list" ]; then
+        if [ -f "/etc/apt/sources.list.back" ]; then
+            echo "备份文件 /etc/apt/sources.list.back 已存在，跳过备份"
+        else
+            echo "备份原有软件源到 /etc/apt/sources.list.back"
+            cp /etc/apt/sources.list /etc/apt/sources.list.back
+        fi
+    fi
+
+    # 复制新的软件源
+    echo "复制新的软件源文件"
+    cp "$SOURCES_LIST_FILE" /etc/apt/sources.list
+    echo "√ 软件源替换完成"
+}
+
+# --------------------- 安装机器人串口和USB ACM设备规则 ---------------------
+done_udev_rules() {
+    cmp -s "$ROBOT_SERIAL_RULES_FILE" /etc/udev/rules.d/99-robot-serial.rules && \
+        cmp -s "$USB_ACM_RULES_FILE" /etc/udev/rules.d/70-usbACM.rules
+}
+
+step_udev_rules() {
+    cp -v "$ROBOT_SERIAL_RULES_FILE" /etc/udev/rules.d/99-robot-serial.rules
+    echo "已安装机器人串口规则：/etc/udev/rules.d/99-robot-serial.rules"
+    cp -v "$USB_ACM_RULES_FILE" /etc/udev/rules.d/70-usbACM.rules
+    echo "已安装USB ACM设备规则：/etc/udev/rules.d/70-usbACM.rules"
+
+    # 重载所有udev规则
+    echo "重载udev规则..."
+    udevadm control --reload-rules
+    udevadm trigger
+    echo "√ 所有udev规则安装完成"
+}
+
+# --------------------- 安装软件包 ---------------------
+done_packages() {
+    local pkg
+    for pkg in "${REQUIRED_PACKAGES[@]}"; do
+        pkg_installed "$pkg" || return 1
+    done
+    ! pkg_installed brltty
+}
+
+packages_install() {
+    if [ -n "$OFFLINE_DIR" ]; then
+        echo "使用离线软件包目录: $OFFLINE_DIR"
+    fi
+    apt_get update -qq
+
+    # brltty 会占用CH341串口
+    systemctl stop brltty 2>/dev/null || true
+    systemctl disable brltty 2>/dev/null || true
+    if pkg_installed brltty; then
+        apt_get remove -y brltty
+        apt_get autoremove -y
+    fi
+
+    echo "安装基础工具、开发工具集、Python环境和WiFi驱动: ${REQUIRED_PACKAGES[*]}"
+    apt_get install -y "${REQUIRED_PACKAGES[@]}" || {
+        echo "警告: 软件包安装失败，尝试修复..."
+        apt_get --fix-broken install -y
+        apt_get install -y "${REQUIRED_PACKAGES[@]}"
+    }
+    apt_get install -y "${OPTIONAL_PACKAGES[@]}" || \
+        echo "警告: 可选软件包 ${OPTIONAL_PACKAGES[*]} 安装失败，继续执行"
+    echo "√ 软件包安装完成"
+}
+
+step_packages() {
+    with_dpkg_lock packages_install
 }
-echo "√ 基础工具安装完成"
 
 # --------------------- 系统更新 ---------------------
-echo "步骤4: 执行系统更新（确保内核和驱动兼容性）"
-echo "开始系统升级，这可能需要几分钟时间..."
-echo "处理可能的NVIDIA包冲突..."
-
-# 先尝试修复可能的包问题
-apt --fix-broken install -y
-
-# 如果upgrade失败，尝试排除有问题的nvidia包
-if ! apt upgrade -y; then
-    echo "升级过程中遇到错误，尝试排除有问题的NVIDIA包..."
-    
-    # 标记有问题的nvidia包为hold，暂时不升级
-    apt-mark hold nvidia-l4t-initrd 2>/dev/null || true
-    
-    # 重新尝试升级其他包
-    echo "重新尝试升级其他包..."
-    if apt upgrade -y; then
-        echo "√ 系统更新完成（已跳过有问题的NVIDIA包）"
-        echo "提示：nvidia-l4t-initrd 包已被暂时保留，避免升级冲突"
+# 24小时内升级过则跳过
+done_upgrade() {
+    [ -n "$(find "$STATE_DIR/upgrade.stamp" -mmin -1440 2>/dev/null)" ]
+}
+
+system_upgrade() {
+    echo "执行系统更新（确保内核和驱动兼容性），这可能需要几分钟时间..."
+    echo "处理可能的NVIDIA包冲突..."
+
+    # 先尝试修复可能的包问题
+    apt --fix-broken install -y
+
+    # 如果upgrade失败，尝试排除有问题的nvidia包
+    if ! apt upgrade -y; then
+        echo "升级过程中遇到错误，尝试排除有问题的NVIDIA包..."
+
+        # 标记有问题的nvidia包为hold，暂时不升级
+        apt-mark hold nvidia-l4t-initrd 2>/dev/null || true
+
+        # 重新尝试升级其他包
+        echo "重新尝试升级其他包..."
+        if apt upgrade -y; then
+            echo "√ 系统更新完成（已跳过有问题的NVIDIA包）"
+            echo "提示：nvidia-l4t-initrd 包已被暂时保留，避免升级冲突"
+        else
+            echo "警告：系统升级仍有问题，继续执行后续步骤..."
+        fi
     else
-        echo "警告：系统升级仍有问题，继续执行后续步骤..."
+        echo "√ 系统更新完成"
+    fi
+}
+
+step_upgrade() {
+    with_dpkg_lock system_upgrade
+    touch "$STATE_DIR/upgrade.stamp"
+}
+
+# --------------------- 安装CH341驱动 ---------------------
+done_ch341() {
+    cmp -s "$KO_FILE" "/lib/modules/$(uname -r)/kernel/drivers/usb/serial/ch341.ko" && \
+        grep -q "ch341" /etc/modules && \
+        cmp -s "$CH341_RULES_FILE" /etc/udev/rules.d/99-ch341.rules
+}
+
+step_ch341() {
+    echo "安装 CH341 驱动 ($KO_FILE)"
+    chmod +x "$INSTALL_SCRIPT"  # 确保脚本可执行
+    # 所需软件包已由 packages 步骤安装
+    SKIP_APT=1 "$INSTALL_SCRIPT" "$KO_FILE"
+    echo "√ CH341驱动安装完成"
+}
+
+# --------------------- 安装dfu工具 ---------------------
+done_dfu() {
+    [ "$(dpkg-query -W -f='${Version}' dfu-util 2>/dev/null)" = "$(dpkg-deb -f "$DFU_DEB_FILE" Version)" ] && \
+        cmp -s "$DFU_RULES_FILE" /etc/udev/rules.d/99-dfu-devices.rules
+}
+
+step_dfu() {
+    echo "安装DFU工具 ($DFU_DEB_FILE)"
+    chmod +x "$DFU_INSTALL_SCRIPT"  # 确保脚本可执行
+    # 离线模式下依赖修复同样只使用离线目录
+    if [ -n "$OFFLINE_DIR" ]; then
+        export APT_SOURCE_LIST="$OFFLINE_LIST"
     fi
-else
-    echo "√ 系统更新完成"
+    with_dpkg_lock "$DFU_INSTALL_SCRIPT" "$DFU_DEB_FILE"
+    echo "√ DFU工具安装完成"
+}
+
+# --------------------- 配置GPIO初始化脚本开机启动 ---------------------
+done_gpio_init() {
+    cmp -s "$GPIO_SCRIPT" /etc/gpio/initial_gpio.sh && \
+        cmp -s "$GPIO_SERVICE" /etc/systemd/system/gpio-init.service && \
+        systemctl is-enabled --quiet gpio-init.service
+}
+
+step_gpio_init() {
+    # 创建目标目录
+    echo "创建GPIO文件目录..."
+    mkdir -p /etc/gpio
+
+    # 复制GPIO初始化脚本到系统目录
+    echo "复制GPIO初始化脚本..."
+    cp -v "$GPIO_SCRIPT" /etc/gpio/
+    chmod +x /etc/gpio/initial_gpio.sh
+
+    # 复制systemd服务文件
+    echo "安装GPIO初始化服务..."
+    cp -v "$GPIO_SERVICE" /etc/systemd/system/
+
+    # 启用并启动服务
+    echo "启用GPIO初始化服务..."
+    systemctl daemon-reload
+    systemctl enable gpio-init.service
+    systemctl start gpio-init.service
+
+    echo "√ GPIO初始化脚本已配置为开机启动"
+}
+
+# --------------------- 安装GPIO守护进程 ---------------------
+done_gpio_daemon() {
+    [ -x /usr/local/bin/gpio_daemon ] && \
+        systemctl is-enabled --quiet gpio-daemon.service && \
+        [ "$(cat "$STATE_DIR/gpio_daemon.sha256" 2>/dev/null)" = \
+          "$(files_hash "$GPIO_DAEMON_SOURCE" "$GPIO_DAEMON_SERVICE")" ]
+}
+
+step_gpio_daemon() {
+    # 切换到GPIO目录并执行安装脚本
+    echo "切换到GPIO目录并安装GPIO守护进程..."
+    local script_dir script_name
+    script_dir="$(dirname "$GPIO_DAEMON_INSTALL_SCRIPT")"
+    script_name="$(basename "$GPIO_DAEMON_INSTALL_SCRIPT")"
+    chmod +x "$GPIO_DAEMON_INSTALL_SCRIPT"
+    # 所需软件包已由 packages 步骤安装，不在锁外、也不绕过离线目录调用apt
+    ( cd "$script_dir" && SKIP_APT=1 "./$script_name" )
+
+    files_hash "$GPIO_DAEMON_SOURCE" "$GPIO_DAEMON_SERVICE" > "$STATE_DIR/gpio_daemon.sha256"
+    echo "√ GPIO守护进程安装完成"
+}
+
+# =================================================================
+# 步骤调度：依赖满足的步骤并行执行
+# =================================================================
+STEPS=(sources udev_rules packages upgrade ch341 dfu gpio_init gpio_daemon)
+
+declare -A STEP_DESC=(
+    [sources]="替换软件源"
+    [udev_rules]="安装机器人串口/USB ACM规则"
+    [packages]="安装软件包"
+    [upgrade]="系统更新"
+    [ch341]="安装CH341驱动"
+    [dfu]="安装DFU工具"
+    [gpio_init]="配置GPIO初始化服务"
+    [gpio_daemon]="安装GPIO守护进程"
+)
+
+# 每个步骤依赖的步骤
+declare -A STEP_DEPS=(
+    [packages]="sources"
+    [upgrade]="packages"
+    [ch341]="packages"
+    [dfu]="packages"
+    [gpio_init]="packages"               # initial_gpio.sh 需要 busybox
+    [gpio_daemon]="packages gpio_init"
+)
+
+# 离线模式不替换软件源、不执行系统更新，两个步骤不参与调度，--force 也不会执行
+if [ -n "$OFFLINE_DIR" ]; then
+    STEPS=(udev_rules packages ch341 dfu gpio_init gpio_daemon)
+    STEP_DEPS[packages]=""
 fi
 
-# --------------------- 安装开发工具和WiFi驱动 ---------------------
-echo "步骤5: 安装开发工具集、Python环境和WiFi驱动 (picocom/sshpass/stlink-tools/byobu/python3.10-venv/iwlwifi-modules)"
-apt install -y \
-    picocom \
-    sshpass \
-    stlink-tools \
-    byobu \
-    python3.10-venv \
-    iwlwifi-modules
-echo "√ 所有开发工具、Python环境和WiFi驱动安装完成"
+declare -A STEP_STATE   # pending/running/done/skipped/failed/blocked
+declare -A STEP_PID
+declare -A STEP_START
+declare -A STEP_TIME
+
+LOG_DIR=$(mktemp -d)
+trap 'rm -rf "$LOG_DIR"' EXIT
+
+now() {
+    date +%s.%N
+}
+
+elapsed() {
+    awk -v a="$1" -v b="$2" 'BEGIN { printf "%.1f", b - a }'
+}
+
+# 依赖状态：0=全部完成 1=尚未完成 2=依赖失败
+deps_state() {
+    local dep
+    for dep in ${STEP_DEPS[$1]:-}; do
+        case "${STEP_STATE[$dep]}" in
+            done|skipped) ;;
+            failed|blocked) return 2 ;;
+            *) return 1 ;;
+        esac
+    done
+    return 0
+}
+
+start_step() {
+    local step="$1"
+    STEP_START[$step]=$(now)
+
+    if [ "$FORCE_ALL" != true ] && "done_$step" >/dev/null 2>&1; then
+        STEP_STATE[$step]=skipped
+        STEP_TIME[$step]=$(elapsed "${STEP_START[$step]}" "$(now)")
+        echo "[$step] ${STEP_DESC[$step]}: 已完成，跳过"
+        return
+    fi
+
+    echo "[$step] ${STEP_DESC[$step]}: 开始"
+    ( set -e; "step_$step" ) > "$LOG_DIR/$step.log" 2>&1 &
+    STEP_PID[$step]=$!
+    STEP_STATE[$step]=running
+}
+
+finish_step() {
+    local step="$1" rc="$2"
+    STEP_TIME[$step]=$(elapsed "${STEP_START[$step]}" "$(now)")
+    sed "s/^/[$step] /" "$LOG_DIR/$step.log"
+    if [ "$rc" -eq 0 ]; then
+        STEP_STATE[$step]=done
+        echo "[$step] ${STEP_DESC[$step]}: 完成 (${STEP_TIME[$step]}s)"
+    else
+        STEP_STATE[$step]=failed
+        echo "[$step] ${STEP_DESC[$step]}: 失败，退出码 $rc (${STEP_TIME[$step]}s)"
+    fi
+}
+
+run_steps() {
+    local step running rc progress
+    for step in "${STEPS[@]}"; do
+        STEP_STATE[$step]=pending
+    done
+
+    while true; do
+        progress=false
+        running=0
+        for step in "${STEPS[@]}"; do
+            [ "${STEP_STATE[$step]}" = running ] && running=$((running + 1))
+        done
+
+        # 启动依赖已满足的步骤
+        for step in "${STEPS[@]}"; do
+            [ "${STEP_STATE[$step]}" = pending ] || continue
+            rc=0
+            deps_state "$step" || rc=$?
+            if [ $rc -eq 2 ]; then
+                STEP_STATE[$step]=blocked
+                echo "[$step] ${STEP_DESC[$step]}: 依赖步骤失败，未执行"
+                progress=true
+            elif [ $rc -eq 0 ] && [ $running -lt "$MAX_JOBS" ]; then
+                start_step "$step"
+                [ "${STEP_STATE[$step]}" = running ] && running=$((running + 1))
+                progress=true
+            fi
+        done
+
+        # 跳过的步骤可能立即解锁后续步骤
+        $progress && continue
+        [ $running -eq 0 ] && break
+
+        wait -n 2>/dev/null || true
+
+        # 收集已结束的步骤
+        for step in "${STEPS[@]}"; do
+            [ "${STEP_STATE[$step]}" = running ] || continue
+            if ! kill -0 "${STEP_PID[$step]}" 2>/dev/null; then
+                rc=0
+                wait "${STEP_PID[$step]}" 2>/dev/null || rc=$?
+                finish_step "$step" "$rc"
+            fi
+        done
+    done
+}
+
+echo "======= 开始设备驱动安装 ======="
+if [ -n "$OFFLINE_DIR" ]; then
+    echo "离线模式: $OFFLINE_DIR"
+fi
+echo "并发数: $MAX_JOBS"
+
+TOTAL_START=$(now)
+run_steps
+
+# --------------------- 步骤耗时 ---------------------
+echo ""
+echo "步骤耗时："
+FAILED_STEPS=0
+for step in "${STEPS[@]}"; do
+    case "${STEP_STATE[$step]}" in
+        done)    status="完成" ;;
+        skipped) status="跳过" ;;
+        failed)  status="失败"; FAILED_STEPS=$((FAILED_STEPS + 1)) ;;
+        *)       status="未执行"; FAILED_STEPS=$((FAILED_STEPS + 1)) ;;
+    esac
+    printf "  %-12s %-8s %6ss  %s\n" "$step" "$status" "${STEP_TIME[$step]:--}" "${STEP_DESC[$step]}"
+done
+echo "  总耗时: $(elapsed "$TOTAL_START" "$(now)")s"
 
 # --------------------- 验证WiFi驱动 ---------------------
-echo "步骤5.1: 验证WiFi驱动安装"
+echo ""
+echo "验证WiFi驱动安装"
 echo "WiFi驱动加载信息："
 dmesg | grep iwlwifi | tail -10 || echo "未找到iwlwifi相关信息"
 
@@ -202,7 +638,7 @@ echo "3. 是否需要安装额外的固件包"
 echo "√ WiFi驱动验证完成"
 
 # --------------------- 验证安装 ---------------------
-echo "步骤6: 验证安装结果"
+echo "验证安装结果"
 echo "基础工具验证："
 command -v cpio >/dev/null && echo "状态: cpio 已安装" || echo "警告: cpio 未安装!"
 command -v gzip >/dev/null && echo "状态: gzip 已安装" || echo "警告: gzip 未安装!"
@@ -226,8 +662,6 @@ echo "udev规则验证："
 [ -f "/etc/udev/rules.d/70-usbACM.rules" ] && echo "状态: USB ACM设备规则已安装" || echo "警告: USB ACM设备规则未安装!"
 
 # --------------------- 清理和建议 ---------------------
-echo "步骤7: 清理和后续建议"
-
 # 检查是否有被hold的nvidia包
 if apt-mark showhold | grep -q nvidia-l4t-initrd; then
     echo "检测到nvidia-l4t-initrd包被暂时保留"
@@ -236,85 +670,15 @@ if apt-mark showhold | grep -q nvidia-l4t-initrd; then
     echo "  sudo apt install --reinstall nvidia-l4t-initrd"
 fi
 
-# --------------------- 配置GPIO初始化脚本开机启动 ---------------------
-echo "步骤8: 配置GPIO初始化脚本开机启动"
-
-# 检查GPIO目录是否存在
-if [ ! -d "$GPIO_DIR" ]; then
-    echo "错误: GPIO目录 $GPIO_DIR 不存在!"
-    exit 10
-fi
-
-# 检查GPIO初始化脚本是否存在
-if [ ! -f "$GPIO_SCRIPT" ]; then
-    echo "错误: GPIO初始化脚本 $GPIO_SCRIPT 不存在!"
-    exit 11
-fi
-
-# 检查GPIO服务文件是否存在
-if [ ! -f "$GPIO_SERVICE" ]; then
-    echo "错误: GPIO服务文件 $GPIO_SERVICE 不存在!"
-    exit 12
-fi
-
-# 创建目标目录
-echo "创建GPIO文件目录..."
-mkdir -p /etc/gpio
-
-# 复制GPIO初始化脚本到系统目录
-echo "复制GPIO初始化脚本..."
-cp -v "$GPIO_SCRIPT" /etc/gpio/
-chmod +x /etc/gpio/initial_gpio.sh
-
-# 复制systemd服务文件
-echo "安装GPIO初始化服务..."
-cp -v "$GPIO_SERVICE" /etc/systemd/system/
-
-# 启用并启动服务
-echo "启用GPIO初始化服务..."
-systemctl daemon-reload
-systemctl enable gpio-init.service
-systemctl start gpio-init.service
-
-echo "√ GPIO初始化脚本已配置为开机启动"
-
-# --------------------- 安装GPIO守护进程 ---------------------
-echo "步骤9: 安装GPIO守护进程"
-
-# 检查GPIO守护进程源代码是否存在
-GPIO_DAEMON_SOURCE="${GPIO_DIR}/gpio_daemon.c"
-if [ ! -f "$GPIO_DAEMON_SOURCE" ]; then
-    echo "错误: GPIO守护进程源代码 $GPIO_DAEMON_SOURCE 不存在!"
-    exit 14
-fi
-
-# 检查GPIO守护进程服务文件是否存在
-GPIO_DAEMON_SERVICE="${GPIO_DIR}/gpio-daemon.service"
-if [ ! -f "$GPIO_DAEMON_SERVICE" ]; then
-    echo "错误: GPIO守护进程服务文件 $GPIO_DAEMON_SERVICE 不存在!"
-    exit 15
-fi
-
-# 检查GPIO守护进程安装脚本是否存在
-GPIO_DAEMON_INSTALL_SCRIPT="${GPIO_DIR}/install_gpio.sh"
-if [ ! -f "$GPIO_DAEMON_INSTALL_SCRIPT" ]; then
-    echo "错误: GPIO守护进程安装脚本 $GPIO_DAEMON_INSTALL_SCRIPT 不存在!"
-    exit 13
-fi
-
-# 切换到GPIO目录并执行安装脚本
-echo "切换到GPIO目录并安装GPIO守护进程..."
-script_dir="$(dirname "$GPIO_DAEMON_INSTALL_SCRIPT")"
-script_name="$(basename "$GPIO_DAEMON_INSTALL_SCRIPT")"
-chmod +x "$GPIO_DAEMON_INSTALL_SCRIPT"
-( cd "$script_dir" && "./$script_name" )
-
-echo "√ GPIO守护进程安装完成"
-
 echo "建议："
 echo "1. 重启系统以确保所有驱动正常加载"
 echo "2. 重启后检查WiFi是否正常工作"
 echo "3. 如有WiFi问题，可尝试: sudo systemctl restart NetworkManager"
 echo "4. GPIO初始化已配置为开机自动运行"
 
+if [ $FAILED_STEPS -gt 0 ]; then
+    echo "======= 有 $FAILED_STEPS 个步骤未完成，请检查上述日志 ======="
+    exit 17
+fi
+
 echo "======= 所有操作已完成! ======="
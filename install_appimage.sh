@@ -6,6 +6,7 @@ set -e  # 任何命令失败时立即退出
 # 功能：
 # 1. 安装AppImage到系统目录  2. 自动提取图标  3. 创建桌面快捷方式
 # 4. 创建菜单项  5. 自动权限处理  6. 完整的错误检查
+# 7. 按内容哈希缓存，AppImage未变化时跳过  8. 批量并行安装
 # =================================================================
 
 # --------------------- 配置参数 ---------------------
@@ -13,6 +14,11 @@ APPIMAGE_DIR="/opt/appimages"          # AppImage安装目录
 DESKTOP_DIR="/usr/share/applications"   # 系统桌面文件目录
 ICON_DIR="/usr/share/pixmaps"          # 系统图标目录
 USER_DESKTOP_DIR="$HOME/Desktop"       # 用户桌面目录
+CACHE_DIR="$APPIMAGE_DIR/.cache"       # 内容寻址缓存目录
+OBJECT_DIR="$CACHE_DIR/objects"        # 按SHA256存放的AppImage
+ICON_CACHE_DIR="$CACHE_DIR/icons"      # 按SHA256存放的已提取图标
+STAMP_DIR="$CACHE_DIR/installed"       # 每个应用的安装记录: 哈希 名称 类别
+SCRIPT_PATH="$(readlink -f "$0")"
 
 # --------------------- 颜色输出 ---------------------
 RED='\033[0;31m'
@@ -43,30 +49,171 @@ show_usage() {
     echo "AppImage 安装脚本"
     echo ""
     echo "用法:"
-    echo "  $0 [AppImage文件路径] [可选:应用名称] [可选:类别]"
+    echo "  $0 [选项] [AppImage文件路径] [可选:应用名称] [可选:类别]"
+    echo "  $0 --batch [-j 并发数] AppImage文件1[:名称[:类别]] [AppImage文件2 ...]"
     echo ""
     echo "参数:"
     echo "  AppImage文件路径  - 要安装的AppImage文件路径"
-    echo "  应用名称         - 显示名称 (默认从文件名推断)"
-    echo "  类别            - 应用类别 (如: Development, Graphics, Office等)"
+    echo "  应用名称         - 显示名称 (默认沿用上次安装记录，没有记录时从文件名推断)"
+    echo "  类别            - 应用类别 (如: Development, Graphics, Office等，默认沿用上次安装记录或Utility)"
+    echo ""
+    echo "选项:"
+    echo "  --batch         - 并行安装多个AppImage，结束后统一刷新一次桌面数据库和图标缓存"
+    echo "  -j 并发数        - 批量安装的并发数 (默认CPU核数)"
+    echo "  --force         - 忽略缓存，强制重新安装"
+    echo "  --no-refresh    - 不刷新桌面数据库和图标缓存"
     echo ""
     echo "示例:"
     echo "  $0 ./MyApp.AppImage"
     echo "  $0 ./MyApp.AppImage \"我的应用\" \"Development\""
+    echo "  $0 --batch -j 4 ./apps/*.AppImage"
+    echo "  $0 --batch ./MyApp.AppImage:\"我的应用\":Development ./Other.AppImage"
     echo ""
     echo "支持的类别: AudioVideo, Development, Education, Game, Graphics,"
     echo "           Internet, Office, Science, Settings, System, Utility"
 }
 
+# --------------------- 权限辅助 ---------------------
+check_permissions() {
+    if [ "$(id -u)" != "0" ]; then
+        print_warning "检测到非root权限，某些操作需要sudo权限"
+        NEED_SUDO=true
+    else
+        NEED_SUDO=false
+    fi
+}
+
+# 按需使用sudo执行命令
+run_priv() {
+    if [ "$NEED_SUDO" = true ]; then
+        sudo "$@"
+    else
+        "$@"
+    fi
+}
+
+# --------------------- 刷新桌面缓存 ---------------------
+refresh_desktop_caches() {
+    print_info "更新桌面数据库..."
+
+    if command -v update-desktop-database >/dev/null 2>&1; then
+        run_priv update-desktop-database "$DESKTOP_DIR" 2>/dev/null || true
+        print_success "桌面数据库已更新"
+    fi
+
+    # 更新图标缓存
+    if command -v gtk-update-icon-cache >/dev/null 2>&1; then
+        run_priv gtk-update-icon-cache -f -t "$ICON_DIR" 2>/dev/null || true
+        print_success "图标缓存已更新"
+    fi
+}
+
+# --------------------- 批量并行安装 ---------------------
+run_batch() {
+    local max_jobs="$1"
+    shift
+
+    if [ $# -eq 0 ]; then
+        print_error "批量模式需要至少一个AppImage文件"
+        exit 1
+    fi
+
+    check_permissions
+    # 提前获取sudo凭据，避免多个并行任务同时提示输入密码
+    if [ "$NEED_SUDO" = true ]; then
+        sudo -v
+    fi
+
+    local log_dir
+    log_dir=$(mktemp -d)
+    local start=$SECONDS
+    local files=("$@")
+    local i
+
+    print_info "并行安装 ${#files[@]} 个AppImage (并发数: $max_jobs)..."
+
+    for i in "${!files[@]}"; do
+        while [ "$(jobs -rp | wc -l)" -ge "$max_jobs" ]; do
+            wait -n 2>/dev/null || true
+        done
+        (
+            # 每项格式为 文件[:名称[:类别]]，未指定的名称和类别由单个安装沿用安装记录
+            IFS=: read -r file name category <<< "${files[$i]}"
+            rc=0
+            "$SCRIPT_PATH" --no-refresh $FORCE_FLAG "$file" "$name" "$category" >"$log_dir/$i.log" 2>&1 || rc=$?
+            echo "$rc" >"$log_dir/$i.rc"
+        ) &
+    done
+    wait
+
+    local installed=0 skipped=0 failed=0
+    for i in "${!files[@]}"; do
+        local rc
+        rc=$(cat "$log_dir/$i.rc" 2>/dev/null || echo 1)
+        if [ "$rc" != "0" ]; then
+            failed=$((failed + 1))
+            print_error "安装失败: ${files[$i]}"
+            sed 's/^/    /' "$log_dir/$i.log" >&2
+        elif grep -q "未变化" "$log_dir/$i.log"; then
+            skipped=$((skipped + 1))
+            print_success "未变化，已跳过: ${files[$i]}"
+        else
+            installed=$((installed + 1))
+            print_success "已安装: ${files[$i]}"
+        fi
+    done
+    rm -rf "$log_dir"
+
+    # 所有应用安装完成后统一刷新一次
+    if [ $installed -gt 0 ]; then
+        refresh_desktop_caches
+    fi
+
+    echo ""
+    echo "======= 批量安装完成 ======="
+    echo "安装: $installed  跳过: $skipped  失败: $failed  耗时: $((SECONDS - start))秒"
+    [ $failed -eq 0 ]
+}
+
 # --------------------- 参数检查 ---------------------
 if [ $# -eq 0 ] || [ "$1" = "-h" ] || [ "$1" = "--help" ]; then
     show_usage
     exit 0
 fi
 
+BATCH_MODE=false
+BATCH_JOBS=$(nproc 2>/dev/null || echo 4)
+FORCE_INSTALL=false
+FORCE_FLAG=""
+NO_REFRESH=false
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --batch)      BATCH_MODE=true; shift ;;
+        -j)           BATCH_JOBS="$2"; shift 2 ;;
+        --force)      FORCE_INSTALL=true; FORCE_FLAG="--force"; shift ;;
+        --no-refresh) NO_REFRESH=true; shift ;;
+        *)            break ;;
+    esac
+done
+
+if [ "$BATCH_MODE" = true ]; then
+    if ! [[ "$BATCH_JOBS" =~ ^[1-9][0-9]*$ ]]; then
+        print_error "无效的并发数: $BATCH_JOBS"
+        exit 1
+    fi
+    run_batch "$BATCH_JOBS" "$@"
+    exit $?
+fi
+
+if [ $# -eq 0 ]; then
+    show_usage
+    exit 1
+fi
+
 APPIMAGE_FILE="$1"
 APP_NAME="${2:-}"
-APP_CATEGORY="${3:-Utility}"
+APP_CATEGORY="${3:-}"
 
 # 检查AppImage文件是否存在
 if [ ! -f "$APPIMAGE_FILE" ]; then
@@ -82,12 +229,7 @@ fi
 
 # --------------------- 权限检查 ---------------------
 print_info "检查权限..."
-if [ "$(id -u)" != "0" ]; then
-    print_warning "检测到非root权限，某些操作需要sudo权限"
-    NEED_SUDO=true
-else
-    NEED_SUDO=false
-fi
+check_permissions
 
 # --------------------- 提取信息 ---------------------
 print_info "分析AppImage文件..."
@@ -95,6 +237,16 @@ print_info "分析AppImage文件..."
 # 获取文件基本信息
 APPIMAGE_BASENAME=$(basename "$APPIMAGE_FILE")
 APPIMAGE_NAME="${APPIMAGE_BASENAME%.*}"  # 去掉扩展名
+STAMP_FILE="$STAMP_DIR/$APPIMAGE_NAME"
+
+# 未指定名称或类别时沿用上次安装记录，避免批量安装等未传参数的场景改掉自定义的名称和类别
+OLD_HASH=""
+if [ -f "$STAMP_FILE" ]; then
+    IFS=$'\t' read -r OLD_HASH OLD_NAME OLD_CATEGORY < "$STAMP_FILE" || true
+    APP_NAME="${APP_NAME:-$OLD_NAME}"
+    APP_CATEGORY="${APP_CATEGORY:-$OLD_CATEGORY}"
+fi
+APP_CATEGORY="${APP_CATEGORY:-Utility}"
 
 # 如果没有指定应用名称，从文件名推断
 if [ -z "$APP_NAME" ]; then
@@ -106,6 +258,22 @@ fi
 print_info "应用名称: $APP_NAME"
 print_info "应用类别: $APP_CATEGORY"
 
+TARGET_PATH="$APPIMAGE_DIR/$APPIMAGE_BASENAME"
+DESKTOP_FILE="$DESKTOP_DIR/${APPIMAGE_NAME}.desktop"
+
+# --------------------- 缓存检查 ---------------------
+# 以内容哈希、名称和类别作为安装记录，三者都未变化且文件仍在时无需重复安装
+APPIMAGE_HASH=$(sha256sum "$APPIMAGE_FILE" | awk '{print $1}')
+OBJECT_PATH="$OBJECT_DIR/$APPIMAGE_HASH.AppImage"
+STAMP_CONTENT="$APPIMAGE_HASH	$APP_NAME	$APP_CATEGORY"
+
+if [ "$FORCE_INSTALL" != true ] && [ -f "$STAMP_FILE" ] && \
+   [ "$(cat "$STAMP_FILE")" = "$STAMP_CONTENT" ] && \
+   [ -f "$TARGET_PATH" ] && [ -f "$DESKTOP_FILE" ]; then
+    print_success "$APP_NAME 未变化 (sha256: ${APPIMAGE_HASH:0:12})，跳过安装"
+    exit 0
+fi
+
 # --------------------- 创建目录 ---------------------
 print_info "创建必要目录..."
 
@@ -120,58 +288,74 @@ create_dir() {
 
 create_dir "$APPIMAGE_DIR"
 create_dir "$ICON_DIR"
+create_dir "$OBJECT_DIR"
+create_dir "$ICON_CACHE_DIR"
+create_dir "$STAMP_DIR"
 
 # --------------------- 安装AppImage ---------------------
 print_info "安装AppImage到系统目录..."
 
-TARGET_PATH="$APPIMAGE_DIR/$APPIMAGE_BASENAME"
-
-# 复制文件
-if [ "$NEED_SUDO" = true ]; then
-    sudo cp "$APPIMAGE_FILE" "$TARGET_PATH"
-    sudo chmod +x "$TARGET_PATH"
+# 缓存对象：同一内容只保存一份，支持reflink的文件系统上不产生实际数据复制
+if [ -f "$OBJECT_PATH" ]; then
+    print_info "使用缓存对象: $OBJECT_PATH"
 else
-    cp "$APPIMAGE_FILE" "$TARGET_PATH"
-    chmod +x "$TARGET_PATH"
+    run_priv cp --reflink=auto "$APPIMAGE_FILE" "$OBJECT_PATH.tmp.$$"
+    run_priv chmod +x "$OBJECT_PATH.tmp.$$"
+    # 原子重命名，并行安装相同内容时不会读到不完整的文件
+    run_priv mv -f "$OBJECT_PATH.tmp.$$" "$OBJECT_PATH"
 fi
 
+# 安装路径硬链接到缓存对象，跨文件系统时退回reflink/复制
+run_priv ln -f "$OBJECT_PATH" "$TARGET_PATH" 2>/dev/null || \
+    run_priv cp --reflink=auto "$OBJECT_PATH" "$TARGET_PATH"
+
 print_success "AppImage已安装到: $TARGET_PATH"
 
 # --------------------- 提取图标 ---------------------
 print_info "尝试提取应用图标..."
 
 ICON_PATH=""
-TEMP_DIR=$(mktemp -d)
+CACHED_ICON=$(find "$ICON_CACHE_DIR" -maxdepth 1 -name "$APPIMAGE_HASH.*" 2>/dev/null | head -1)
 
-# 尝试从AppImage中提取图标
-if "$TARGET_PATH" --appimage-extract >/dev/null 2>&1; then
+if [ -n "$CACHED_ICON" ]; then
+    print_info "使用缓存图标: $CACHED_ICON"
+else
+    TEMP_DIR=$(mktemp -d)
     cd "$TEMP_DIR"
-    "$TARGET_PATH" --appimage-extract >/dev/null 2>&1 || true
-    
-    # 查找图标文件
-    if [ -d "squashfs-root" ]; then
-        # 常见图标路径
-        for icon_pattern in "*.png" "*.svg" "*.ico" "*.xpm"; do
+
+    # 按模式只提取图标文件，不支持模式参数的运行时会完整提取，随后同样能找到
+    FOUND_ICON=""
+    for icon_pattern in "*.png" "*.svg" "*.ico" "*.xpm"; do
+        if [ ! -d "squashfs-root" ] || [ -z "$(find squashfs-root -name "$icon_pattern" -type f | head -1)" ]; then
+            "$OBJECT_PATH" --appimage-extract "$icon_pattern" >/dev/null 2>&1 || true
+        fi
+        if [ -d "squashfs-root" ]; then
             FOUND_ICON=$(find squashfs-root -name "$icon_pattern" -type f | head -1)
-            if [ -n "$FOUND_ICON" ]; then
-                ICON_EXT="${FOUND_ICON##*.}"
-                ICON_NAME="${APPIMAGE_NAME}.${ICON_EXT}"
-                ICON_PATH="$ICON_DIR/$ICON_NAME"
-                
-                if [ "$NEED_SUDO" = true ]; then
-                    sudo cp "$FOUND_ICON" "$ICON_PATH"
-                else
-                    cp "$FOUND_ICON" "$ICON_PATH"
-                fi
-                
-                print_success "图标已提取: $ICON_PATH"
-                break
-            fi
-        done
+        fi
+        [ -n "$FOUND_ICON" ] && break
+    done
+
+    # 记录到缓存，未找到图标时写入 .none 标记，避免下次重复提取
+    if [ -n "$FOUND_ICON" ]; then
+        CACHED_ICON="$ICON_CACHE_DIR/$APPIMAGE_HASH.${FOUND_ICON##*.}"
+        run_priv cp "$FOUND_ICON" "$CACHED_ICON"
+    else
+        CACHED_ICON="$ICON_CACHE_DIR/$APPIMAGE_HASH.none"
+        run_priv touch "$CACHED_ICON"
     fi
-    
-    # 清理临时文件
-    rm -rf squashfs-root 2>/dev/null || true
+
+    cd - >/dev/null
+
+    # 清理临时目录
+    rm -rf "$TEMP_DIR"
+fi
+
+if [ "${CACHED_ICON##*.}" != "none" ]; then
+    ICON_EXT="${CACHED_ICON##*.}"
+    ICON_PATH="$ICON_DIR/${APPIMAGE_NAME}.${ICON_EXT}"
+    run_priv ln -f "$CACHED_ICON" "$ICON_PATH" 2>/dev/null || \
+        run_priv cp --reflink=auto "$CACHED_ICON" "$ICON_PATH"
+    print_success "图标已提取: $ICON_PATH"
 fi
 
 # 如果没有找到图标，使用默认图标
@@ -180,16 +364,9 @@ if [ -z "$ICON_PATH" ]; then
     ICON_PATH="application-x-executable"
 fi
 
-cd - >/dev/null
-
-# 清理临时目录
-rm -rf "$TEMP_DIR"
-
 # --------------------- 创建桌面文件 ---------------------
 print_info "创建桌面快捷方式..."
 
-DESKTOP_FILE="$DESKTOP_DIR/${APPIMAGE_NAME}.desktop"
-
 # 创建桌面文件内容
 DESKTOP_CONTENT="[Desktop Entry]
 Version=1.0
@@ -240,25 +417,19 @@ MimeType=application/x-appimage;"
 fi
 
 # --------------------- 更新桌面数据库 ---------------------
-print_info "更新桌面数据库..."
-
-if command -v update-desktop-database >/dev/null 2>&1; then
-    if [ "$NEED_SUDO" = true ]; then
-        sudo update-desktop-database "$DESKTOP_DIR" 2>/dev/null || true
-    else
-        update-desktop-database "$DESKTOP_DIR" 2>/dev/null || true
-    fi
-    print_success "桌面数据库已更新"
+if [ "$NO_REFRESH" = true ]; then
+    print_info "跳过桌面数据库和图标缓存更新"
+else
+    refresh_desktop_caches
 fi
 
-# 更新图标缓存
-if command -v gtk-update-icon-cache >/dev/null 2>&1; then
-    if [ "$NEED_SUDO" = true ]; then
-        sudo gtk-update-icon-cache -f -t "$ICON_DIR" 2>/dev/null || true
-    else
-        gtk-update-icon-cache -f -t "$ICON_DIR" 2>/dev/null || true
-    fi
-    print_success "图标缓存已更新"
+# --------------------- 记录安装 ---------------------
+echo "$STAMP_CONTENT" | run_priv tee "$STAMP_FILE" >/dev/null
+
+# 旧版本的缓存对象不再被任何应用引用时删除
+if [ -n "$OLD_HASH" ] && [ "$OLD_HASH" != "$APPIMAGE_HASH" ] && \
+   ! grep -qs "^$OLD_HASH" "$STAMP_DIR"/*; then
+    run_priv rm -f "$OBJECT_DIR/$OLD_HASH.AppImage" "$ICON_CACHE_DIR/$OLD_HASH".*
 fi
 
 # --------------------- 验证安装 ---------------------
@@ -1,6 +1,7 @@
 #!/bin/bash
 # CH341 驱动自动安装脚本 (Ubuntu 22.04)
 # 用法：sudo ./install_ch341.sh /path/to/ch341.ko
+# 环境变量 SKIP_APT=1 时跳过步骤 1（软件包已由 initial_board.sh 统一安装）
 
 # 检查参数
 if [ $# -ne 1 ]; then
@@ -36,12 +37,16 @@ if [ ! -f "$RULES_SRC" ]; then
 fi
 
 echo "=== 步骤 1：准备系统环境 ==="
-apt update
-systemctl stop brltty
-systemctl disable brltty
-apt remove -y brltty
-apt autoremove -y
-apt install -y unzip build-essential linux-headers-$KERNEL_VERSION
+if [ "${SKIP_APT:-0}" = "1" ]; then
+    echo "SKIP_APT=1，跳过软件包安装"
+else
+    apt update
+    systemctl stop brltty
+    systemctl disable brltty
+    apt remove -y brltty
+    apt autoremove -y
+    apt install -y unzip build-essential linux-headers-$KERNEL_VERSION
+fi
 
 echo "=== 步骤 2：安装驱动模块 ==="
 # 创建目标目录
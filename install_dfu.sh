@@ -7,6 +7,7 @@ set -e  # 任何命令失败时立即退出
 # 1. 安装 dfu-util 本地 deb 包
 # 2. 配置 udev 规则
 # 3. 验证安装结果
+# 环境变量 APT_SOURCE_LIST 指定修复依赖时使用的软件源列表（initial_board.sh 离线模式传入）
 # =================================================================
 
 # --------------------- 权限验证 ---------------------
@@ -43,7 +44,13 @@ if dpkg -i "$DFU_DEB_FILE"; then
 else
     echo "错误: dfu-util包安装失败"
     echo "尝试修复依赖关系..."
-    apt-get install -f -y
+    if [ -n "${APT_SOURCE_LIST:-}" ]; then
+        apt-get -o Dir::Etc::SourceList="$APT_SOURCE_LIST" \
+                -o Dir::Etc::SourceParts="-" \
+                -o APT::Get::List-Cleanup="0" install -f -y
+    else
+        apt-get install -f -y
+    fi
     echo "依赖关系修复完成，重新尝试安装..."
     dpkg -i "$DFU_DEB_FILE"
     echo "√ dfu-util本地包安装完成"
@@ -131,6 +131,20 @@ test_parameter_validation() {
         print_result 1
     fi
     
+    print_test "测试批量模式缺少文件"
+    if ! ./install_appimage.sh --batch >/dev/null 2>&1; then
+        print_result 0  # 应该失败
+    else
+        print_result 1
+    fi
+    
+    print_test "测试批量模式无效并发数"
+    if ! ./install_appimage.sh --batch -j 0 "nonexistent.AppImage" >/dev/null 2>&1; then
+        print_result 0  # 应该失败
+    else
+        print_result 1
+    fi
+    
     print_test "测试卸载脚本 --list 选项"
     if ./uninstall_appimage.sh --list >/dev/null 2>&1; then
         print_result 0
@@ -145,7 +159,7 @@ test_parameter_validation() {
 test_dependencies() {
     print_header "测试系统依赖"
     
-    local deps=("file" "find" "basename" "dirname" "mktemp")
+    local deps=("file" "find" "basename" "dirname" "mktemp" "sha256sum")
     local missing=0
     
     for dep in "${deps[@]}"; do
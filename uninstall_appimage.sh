@@ -13,6 +13,10 @@ APPIMAGE_DIR="/opt/appimages"
 DESKTOP_DIR="/usr/share/applications"
 ICON_DIR="/usr/share/pixmaps"
 USER_DESKTOP_DIR="$HOME/Desktop"
+CACHE_DIR="$APPIMAGE_DIR/.cache"       # install_appimage.sh 的内容寻址缓存
+OBJECT_DIR="$CACHE_DIR/objects"
+ICON_CACHE_DIR="$CACHE_DIR/icons"
+STAMP_DIR="$CACHE_DIR/installed"
 
 # --------------------- 颜色输出 ---------------------
 RED='\033[0;31m'
@@ -74,7 +78,7 @@ get_installed_appimages() {
             basename=$(basename "$file")
             name="${basename%.*}"
             appimages+=("$name:$file")
-        done < <(find "$APPIMAGE_DIR" -name "*.AppImage" -type f -print0 2>/dev/null)
+        done < <(find "$APPIMAGE_DIR" -path "$CACHE_DIR" -prune -o -name "*.AppImage" -type f -print0 2>/dev/null)
     fi
     
     printf '%s\n' "${appimages[@]}"
@@ -111,6 +115,25 @@ list_appimages() {
     echo ""
 }
 
+# --------------------- 清理缓存 ---------------------
+# 删除没有任何安装记录引用的缓存对象和图标
+prune_cache() {
+    [ -d "$OBJECT_DIR" ] || return 0
+    
+    local obj hash
+    for obj in "$OBJECT_DIR"/*.AppImage; do
+        [ -e "$obj" ] || continue
+        hash=$(basename "$obj" .AppImage)
+        if ! grep -qs "^$hash" "$STAMP_DIR"/*; then
+            if [ "$NEED_SUDO" = true ]; then
+                sudo rm -f "$obj" "$ICON_CACHE_DIR/$hash".*
+            else
+                rm -f "$obj" "$ICON_CACHE_DIR/$hash".*
+            fi
+        fi
+    done
+}
+
 # --------------------- 卸载单个AppImage ---------------------
 uninstall_appimage() {
     local target_name="$1"
@@ -121,7 +144,7 @@ uninstall_appimage() {
     # 搜索AppImage文件
     local appimage_file=""
     if [ -d "$APPIMAGE_DIR" ]; then
-        appimage_file=$(find "$APPIMAGE_DIR" -name "*${target_name}*" -type f | head -1)
+        appimage_file=$(find "$APPIMAGE_DIR" -path "$CACHE_DIR" -prune -o -name "*${target_name}*" -type f -print | head -1)
     fi
     
     if [ -z "$appimage_file" ]; then
@@ -190,6 +213,16 @@ uninstall_appimage() {
         fi
     done
     
+    # 删除安装记录和不再被引用的缓存对象
+    if [ -f "$STAMP_DIR/$name" ]; then
+        if [ "$NEED_SUDO" = true ]; then
+            sudo rm -f "$STAMP_DIR/$name"
+        else
+            rm -f "$STAMP_DIR/$name"
+        fi
+        prune_cache
+    fi
+    
     print_success "应用 '$name' 卸载完成"
     found=true
     
@@ -266,11 +299,13 @@ uninstall_all() {
         echo ""
     done
     
-    # 清理空目录
+    # 清理缓存和空目录
     if [ -d "$APPIMAGE_DIR" ]; then
         if [ "$NEED_SUDO" = true ]; then
+            sudo rm -rf "$CACHE_DIR"
             sudo rmdir "$APPIMAGE_DIR" 2>/dev/null || true
         else
+            rm -rf "$CACHE_DIR"
             rmdir "$APPIMAGE_DIR" 2>/dev/null || true
         fi
     fi